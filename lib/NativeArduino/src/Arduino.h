@@ -0,0 +1,136 @@
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Just enough of the Arduino core for the GATE_SIMULATION build to run on the host
+// Pins, interrupts and the clock all go through the simulation, so the hardware calls here do nothing
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+// Uno pin layout, so the profile checks in Config.h hold the same as on the board
+#define NUM_DIGITAL_PINS 20
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+// Flash strings are ordinary strings on the host
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void attachInterrupt(uint8_t, void (*)(), int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// Wall clock time, only used to measure how long host code takes, the gate logic reads the simulated clock
+unsigned long millis();
+unsigned long micros();
+
+// Not part of the Arduino core, the native benchmark needs a finer clock than micros()
+uint64_t nanos();
+
+// Nothing waits on the host, simulated time only moves in CSimulation::Step
+inline void delay(unsigned long) {}
+
+long random(long Max);
+long random(long Min, long Max);
+
+class String
+{
+public:
+    String(const char *Text = "") : Value(Text) {}
+    String(const std::string &Text) : Value(Text) {}
+
+    String &operator+=(char Character)
+    {
+        Value += Character;
+        return *this;
+    }
+
+    bool operator==(const char *Other) const { return Value == Other; }
+    unsigned int length() const { return Value.size(); }
+    unsigned char reserve(unsigned int Size)
+    {
+        Value.reserve(Size);
+        return 1;
+    }
+    const char *c_str() const { return Value.c_str(); }
+    int indexOf(char Character) const
+    {
+        size_t Found = Value.find(Character);
+        return Found == std::string::npos ? -1 : static_cast<int>(Found);
+    }
+    String substring(unsigned int Begin) const { return Begin < Value.size() ? String(Value.substr(Begin)) : String(); }
+    String substring(unsigned int Begin, unsigned int End) const
+    {
+        return Begin < End && Begin < Value.size() ? String(Value.substr(Begin, End - Begin)) : String();
+    }
+    long toInt() const { return atol(Value.c_str()); }
+    bool startsWith(const char *Prefix) const { return Value.compare(0, std::string(Prefix).size(), Prefix) == 0; }
+
+private:
+    std::string Value;
+};
+
+// Writes to stdout, reads the commands given on the command line as if they had been typed in
+class HardwareSerial
+{
+public:
+    void begin(unsigned long) {}
+    void flush();
+
+    int available();
+    int read();
+
+    // queues a line of input
+    void AddInput(const char *Line);
+
+    void print(const __FlashStringHelper *Text) { print(reinterpret_cast<const char *>(Text)); }
+    void print(const char *Text);
+    void print(const String &Text) { print(Text.c_str()); }
+    void print(char Character);
+    void print(int Number) { print(static_cast<long>(Number)); }
+    void print(unsigned int Number) { print(static_cast<unsigned long>(Number)); }
+    void print(unsigned char Number) { print(static_cast<unsigned long>(Number)); }
+    void print(long Number);
+    void print(unsigned long Number);
+
+    template <typename T>
+    void println(T Value)
+    {
+        print(Value);
+        println();
+    }
+    void println() { print('\n'); }
+
+private:
+    std::string Input;
+};
+
+extern HardwareSerial Serial;
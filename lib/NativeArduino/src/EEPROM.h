@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// 1 KB of erased EEPROM like a fresh Uno, not kept between runs
+class EEPROMClass
+{
+public:
+    EEPROMClass()
+    {
+        for (size_t i = 0; i < sizeof(Memory); i++)
+        {
+            Memory[i] = 0xFF;
+        }
+    }
+
+    template <typename T>
+    T &get(int Address, T &Value)
+    {
+        uint8_t *Bytes = reinterpret_cast<uint8_t *>(&Value);
+        for (size_t i = 0; i < sizeof(T); i++)
+        {
+            Bytes[i] = Memory[Address + i];
+        }
+        return Value;
+    }
+
+    // Only changed bytes are written, like the AVR core, the cells are volatile so a repeated put is still done
+    // every time and the native benchmark measures something
+    template <typename T>
+    const T &put(int Address, const T &Value)
+    {
+        const uint8_t *Bytes = reinterpret_cast<const uint8_t *>(&Value);
+        for (size_t i = 0; i < sizeof(T); i++)
+        {
+            if (Memory[Address + i] != Bytes[i])
+            {
+                Memory[Address + i] = Bytes[i];
+            }
+        }
+        return Value;
+    }
+
+private:
+    volatile uint8_t Memory[1024];
+};
+
+extern EEPROMClass EEPROM;
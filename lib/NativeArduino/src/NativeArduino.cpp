@@ -0,0 +1,105 @@
+// the standard headers go first, Arduino.h defines min and max as macros
+#include <chrono>
+#include <stdio.h>
+#include "Arduino.h"
+#include "EEPROM.h"
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+static const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+unsigned long micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+uint64_t nanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+long random(long Max)
+{
+    return Max > 0 ? rand() % Max : 0;
+}
+
+long random(long Min, long Max)
+{
+    return Min + random(Max - Min);
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+int HardwareSerial::available()
+{
+    return Input.size();
+}
+
+int HardwareSerial::read()
+{
+    if (Input.empty())
+    {
+        return -1;
+    }
+
+    int Character = static_cast<unsigned char>(Input[0]);
+    Input.erase(0, 1);
+    return Character;
+}
+
+void HardwareSerial::AddInput(const char *Line)
+{
+    Input += Line;
+    Input += '\n';
+}
+
+void HardwareSerial::print(const char *Text)
+{
+    fputs(Text, stdout);
+}
+
+void HardwareSerial::print(char Character)
+{
+    putchar(Character);
+}
+
+void HardwareSerial::print(long Number)
+{
+    printf("%ld", Number);
+}
+
+void HardwareSerial::print(unsigned long Number)
+{
+    printf("%lu", Number);
+}
+
+// Unit tests bring their own main and never run the firmware
+#ifndef PIO_UNIT_TESTING
+void setup();
+void loop();
+
+// Each argument is a serial command, e.g. program "simtraffic 600" "simdays 1000"
+// runs until a simdays limit is reached, or forever without one
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        Serial.AddInput(argv[i]);
+    }
+
+    setup();
+    for (;;)
+    {
+        loop();
+    }
+}
+#endif
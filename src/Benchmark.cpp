@@ -0,0 +1,357 @@
+#include "Benchmark.h"
+
+#ifdef GATE_BENCHMARK
+
+#ifndef GATE_SIMULATION
+#error "GATE_BENCHMARK drives the gates through the simulated pins, GATE_SIMULATION must be defined too"
+#endif
+
+#include "EEPROM.h"
+#include "Config.h"
+#include "Gate.h"
+#include "Simulation.h"
+#include "PulseDecoder.h"
+#include "BenchmarkBaseline.h"
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#endif
+
+// from main.cpp
+extern CGate *Gates[GATE_COUNT];
+void loop();
+
+// Loops averaged for the idle loop benchmark
+static const uint8_t IdleLoops = 100;
+
+// Timers updated together for the timer benchmark
+static const uint8_t BenchmarkTimerCount = 16;
+
+#ifdef __AVR__
+// Timer1 counts cycles exactly, one run of a benchmark is enough
+static const uint16_t BenchmarkRepeats = 1;
+static const uint16_t BeamRepeats = 1;
+#else
+// The host clock is noisy next to a single run, benchmarks without side effects are repeated and averaged,
+// the beam is broken fewer times as every break logs the stop and reversal
+static const uint16_t BenchmarkRepeats = 10000;
+static const uint16_t BeamRepeats = 100;
+#endif
+
+static bool bAllPassed = true;
+
+#ifdef __AVR__
+static volatile uint16_t TimerOverflows = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+    TimerOverflows++;
+}
+
+// Timer1 with no prescaler counts CPU cycles, overflows are counted so long runs don't wrap
+static void StartMeasure()
+{
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    TimerOverflows = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    TCCR1B = _BV(CS10);
+}
+
+static uint32_t StopMeasure()
+{
+    TCCR1B = 0;
+    uint16_t Count = TCNT1;
+    // an overflow that happened after interrupts were last serviced hasn't been counted yet
+    if (TIFR1 & _BV(TOV1))
+    {
+        TimerOverflows++;
+        TIFR1 = _BV(TOV1);
+    }
+    TIMSK1 = 0;
+    return (static_cast<uint32_t>(TimerOverflows) << 16) | Count;
+}
+
+static const __FlashStringHelper *MeasureUnit()
+{
+    return F("cycles");
+}
+
+static const uint32_t MeasureScale = 1;
+
+static const uint32_t BeamBudget = FConfig::SafetyBeamBudgetMicros * (F_CPU / 1000000UL);
+#else
+static uint64_t MeasureStartNanos = 0;
+
+static void StartMeasure()
+{
+    MeasureStartNanos = nanos();
+}
+
+static uint32_t StopMeasure()
+{
+    return static_cast<uint32_t>(nanos() - MeasureStartNanos);
+}
+
+// Measured in nanoseconds and reported in picoseconds, the averages are often under a nanosecond
+static const __FlashStringHelper *MeasureUnit()
+{
+    return F("ps");
+}
+
+static const uint32_t MeasureScale = 1000;
+
+static const uint32_t BeamBudget = FConfig::SafetyBeamBudgetMicros * 1000000UL;
+#endif
+
+// Turns a measured total over Runs into the reported unit per run
+static uint32_t PerRun(uint32_t Total, uint32_t Runs)
+{
+    return static_cast<uint64_t>(Total) * MeasureScale / Runs;
+}
+
+static void Report(const __FlashStringHelper *Name, uint32_t Value, uint32_t Baseline)
+{
+    const __FlashStringHelper *Status = F("NEW");
+    if (Baseline != 0)
+    {
+        // 64 bit so a small baseline still gets its threshold
+        bool bPassed = static_cast<uint64_t>(Value) * 100 <= static_cast<uint64_t>(Baseline) * (100 + BenchmarkThresholdPercent);
+        Status = bPassed ? F("PASS") : F("FAIL");
+        bAllPassed = bAllPassed && bPassed;
+    }
+    else
+    {
+        // an unrecorded baseline fails the run, otherwise a missing baseline would pass whatever the result
+        bAllPassed = false;
+    }
+
+    Serial.print(F("BENCH,"));
+    Serial.print(Name);
+    Serial.print(F(","));
+    Serial.print(Value);
+    Serial.print(F(","));
+    Serial.print(MeasureUnit());
+    Serial.print(F(","));
+    Serial.print(Baseline);
+    Serial.print(F(","));
+    Serial.println(Status);
+
+    // don't let this line still be going out while the next benchmark runs
+    Serial.flush();
+}
+
+// Times one loop with the simulation paused, so only the firmware is measured
+static uint32_t MeasureLoop()
+{
+    Serial.flush();
+    Simulation->SetPaused(true);
+    StartMeasure();
+    loop();
+    uint32_t Result = StopMeasure();
+    Simulation->SetPaused(false);
+    return Result;
+}
+
+static void BenchmarkIdleLoop()
+{
+    // the first loops print the starting gate positions, get those out of the way
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        loop();
+    }
+
+    const uint32_t Loops = static_cast<uint32_t>(IdleLoops) * BenchmarkRepeats;
+    Serial.flush();
+    Simulation->SetPaused(true);
+    StartMeasure();
+    for (uint32_t i = 0; i < Loops; i++)
+    {
+        loop();
+    }
+    uint32_t Total = StopMeasure();
+    Simulation->SetPaused(false);
+    Report(F("idle_loop"), PerRun(Total, Loops), BaselineIdleLoop);
+}
+
+// The whole loop in which the radio press is decoded and the relay switched on, an upper bound on the latency
+// a press is decoded when it ends, so the press is held past CPulseDecoder::MinPulseMillis with simulated time moving first
+static void BenchmarkCommandToRelay()
+{
+    Simulation->DriveInput(FConfig::Inputs::Radio, HIGH);
+    for (uint16_t i = 0; i < CPulseDecoder::MinPulseMillis * 2; i++)
+    {
+        Simulation->Step();
+        loop();
+    }
+    Simulation->DriveInput(FConfig::Inputs::Radio, LOW);
+
+    uint32_t Result = 0;
+    for (uint16_t i = 0; i < 1000 && !Simulation->DigitalRead(FConfig::LeafA::RelayOpen); i++)
+    {
+        Simulation->Step();
+        Result = MeasureLoop();
+    }
+
+    if (!Simulation->DigitalRead(FConfig::LeafA::RelayOpen))
+    {
+        Serial.println(F("BENCH_ERROR,command_to_relay,relay not switched on"));
+        bAllPassed = false;
+    }
+    Report(F("command_to_relay"), PerRun(Result, 1), BaselineCommandToRelay);
+}
+
+// The whole loop in which the open limit switch is seen and the relay switched off, the gate must be opening
+static void BenchmarkLimitToRelayOff()
+{
+    Simulation->SetPaused(true);
+    Simulation->DigitalWrite(FConfig::LeafA::ReedSwitchClosed, LOW);
+    Simulation->DigitalWrite(FConfig::LeafA::ReedSwitchOpen, HIGH);
+    uint32_t Result = MeasureLoop();
+
+    if (Simulation->DigitalRead(FConfig::LeafA::RelayOpen))
+    {
+        Serial.println(F("BENCH_ERROR,limit_to_relay_off,relay still on"));
+        bAllPassed = false;
+    }
+    Report(F("limit_to_relay_off"), PerRun(Result, 1), BaselineLimitToRelayOff);
+}
+
+// The safety beam interrupt handler, from the beam breaking to the closing relay being dropped
+static void BenchmarkBeamToRelayOff()
+{
+    uint32_t Total = 0;
+    for (uint16_t Repeat = 0; Repeat < BeamRepeats; Repeat++)
+    {
+        Gates[0]->SetClosing();
+        Serial.flush();
+
+        Simulation->SetPaused(true);
+        StartMeasure();
+        Simulation->DriveInput(FConfig::Inputs::SafetyBeam, HIGH);
+        Total += StopMeasure();
+        Simulation->DriveInput(FConfig::Inputs::SafetyBeam, LOW);
+        Simulation->SetPaused(false);
+
+        if (Simulation->DigitalRead(FConfig::LeafA::RelayClose))
+        {
+            Serial.println(F("BENCH_ERROR,beam_to_relay_off,relay still on"));
+            bAllPassed = false;
+        }
+
+        // the gate handles the break, then the reversal is cancelled so the next break starts from the same state
+        loop();
+        Gates[0]->SetIdle();
+    }
+    uint32_t Result = PerRun(Total, BeamRepeats);
+    Report(F("beam_to_relay_off"), Result, BaselineBeamToRelayOff);
+
+    // a hard limit as well as the regression check, this is the latency the beam is there for
+    bool bWithinBudget = Result <= BeamBudget;
+    bAllPassed = bAllPassed && bWithinBudget;
+    Serial.print(F("BENCH_BUDGET,beam_to_relay_off,"));
+    Serial.print(Result);
+    Serial.print(F(","));
+    Serial.print(MeasureUnit());
+    Serial.print(F(","));
+    Serial.print(BeamBudget);
+    Serial.print(F(","));
+    Serial.println(bWithinBudget ? F("PASS") : F("FAIL"));
+    Serial.flush();
+}
+
+static void BenchmarkTimerUpdate()
+{
+    CTimer *Timers[BenchmarkTimerCount];
+    for (uint8_t i = 0; i < BenchmarkTimerCount; i++)
+    {
+        Timers[i] = new CTimer(F("BenchTimer"));
+        Timers[i]->SetTimer(FSeconds::FromInt(60));
+        Timers[i]->StartTimer();
+    }
+
+    StartMeasure();
+    for (uint16_t Repeat = 0; Repeat < BenchmarkRepeats; Repeat++)
+    {
+        for (uint8_t i = 0; i < BenchmarkTimerCount; i++)
+        {
+            Timers[i]->Update();
+        }
+    }
+    uint32_t Result = StopMeasure();
+
+    for (uint8_t i = 0; i < BenchmarkTimerCount; i++)
+    {
+        delete Timers[i];
+    }
+    Report(F("timer_update"), PerRun(Result, static_cast<uint32_t>(BenchmarkTimerCount) * BenchmarkRepeats), BaselineTimerUpdate);
+}
+
+// Puts back the value already stored, EEPROM.put only writes changed bytes so this doesn't wear the EEPROM
+// a changed timeout costs an extra ~3.3ms per byte written on top of this
+static void BenchmarkEEPROMPersist()
+{
+    uint32_t Stored = 0;
+    EEPROM.get(0, Stored);
+
+    StartMeasure();
+    for (uint16_t Repeat = 0; Repeat < BenchmarkRepeats; Repeat++)
+    {
+        EEPROM.put(0, Stored);
+    }
+    uint32_t Result = StopMeasure();
+
+    Report(F("eeprom_persist"), PerRun(Result, BenchmarkRepeats), BaselineEEPROMPersist);
+}
+
+// A typical state change message going into an empty serial buffer
+static void BenchmarkLogEmit()
+{
+    Serial.flush();
+    StartMeasure();
+    Serial.println(F("Gate 0 - Idle State Set"));
+    uint32_t Result = StopMeasure();
+
+    Report(F("log_emit"), PerRun(Result, 1), BaselineLogEmit);
+}
+
+void RunBenchmarks()
+{
+    // nothing but the benchmarks should move the gates
+    Simulation->HandleSerialCommand("simtraffic 0");
+    Simulation->HandleSerialCommand("simobstruct 0");
+
+    Serial.println(F("BENCH_START"));
+    Serial.flush();
+
+    BenchmarkIdleLoop();
+    BenchmarkCommandToRelay();
+    BenchmarkLimitToRelayOff();
+    if (FConfig::bSafetyBeam)
+    {
+        BenchmarkBeamToRelayOff();
+    }
+    BenchmarkTimerUpdate();
+    BenchmarkEEPROMPersist();
+    BenchmarkLogEmit();
+
+    Serial.print(F("BENCH_RESULT,"));
+    Serial.println(bAllPassed ? F("PASS") : F("FAIL"));
+    Serial.flush();
+
+#ifdef __AVR__
+    // sleeping with interrupts off never wakes, simavr exits when it sees this
+    cli();
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    sleep_cpu();
+#else
+    // the exit status is the result, so a script can gate on it
+    exit(bAllPassed ? 0 : 1);
+#endif
+}
+
+#endif
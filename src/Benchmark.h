@@ -0,0 +1,13 @@
+#pragma once
+#include <Arduino.h>
+
+// Benchmarks of the controller hot paths, only built with GATE_BENCHMARK (which needs GATE_SIMULATION for its pins)
+// Results are printed one per line as
+//   BENCH,<name>,<value>,<unit>,<baseline>,<PASS|FAIL|NEW>
+// with beam_to_relay_off also checked against FConfig::SafetyBeamBudgetMicros as
+//   BENCH_BUDGET,beam_to_relay_off,<value>,<unit>,<budget>,<PASS|FAIL>
+// followed by BENCH_RESULT,<PASS|FAIL>, and a NEW result with no baseline yet fails the run. On AVR the unit is
+// CPU cycles counted with Timer1, so the numbers are the same on a board and under simavr, and the benchmarks then halt.
+// On the host the unit is picoseconds averaged over many runs with a nanosecond clock, and the program exits with
+// status 0 if the run passed and 1 if not
+void RunBenchmarks();
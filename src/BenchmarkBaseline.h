@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+
+// Benchmark baselines, a result more than BenchmarkThresholdPercent above its baseline fails and so does a
+// baseline of 0, which means it hasn't been recorded yet. Record one by pasting the value from its BENCH line here
+// once a run has been checked
+
+#ifdef __AVR__
+// CPU cycles for the uno_double_bench environment, run under simavr or on a board
+const uint8_t BenchmarkThresholdPercent = 10;
+
+const uint32_t BaselineIdleLoop = 0;
+const uint32_t BaselineCommandToRelay = 0;
+const uint32_t BaselineLimitToRelayOff = 0;
+const uint32_t BaselineBeamToRelayOff = 0;
+const uint32_t BaselineTimerUpdate = 0;
+const uint32_t BaselineEEPROMPersist = 0;
+const uint32_t BaselineLogEmit = 0;
+#else
+// Picoseconds for the native_bench environment, from the median of 30 runs on the development machine.
+// Host timings vary far more than cycle counts, so the threshold is wider and the baselines belong to the machine
+// they were recorded on, record them again on a new one
+const uint8_t BenchmarkThresholdPercent = 100;
+
+const uint32_t BaselineIdleLoop = 75000;
+const uint32_t BaselineCommandToRelay = 3000000;
+const uint32_t BaselineLimitToRelayOff = 2000000;
+const uint32_t BaselineBeamToRelayOff = 80000;
+const uint32_t BaselineTimerUpdate = 3500;
+const uint32_t BaselineEEPROMPersist = 6000;
+const uint32_t BaselineLogEmit = 170000;
+#endif
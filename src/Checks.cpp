@@ -1,7 +1,10 @@
 #include "Checks.h"
 
-CChecks::CChecks()
+CChecks::CChecks(uint8_t _ReedSwitchOpenPin, uint8_t _ReedSwitchClosedPin)
 {
+    ReedSwitchOpenPin = _ReedSwitchOpenPin;
+    ReedSwitchClosedPin = _ReedSwitchClosedPin;
+
     // on init, query the limit switches for position
     // if gate is open
     if(CheckOpenLimitSwitch() && !CheckClosedLimitSwitch())
@@ -25,39 +28,12 @@ CChecks::CChecks()
 
 bool CChecks::CheckOpenLimitSwitch()
 {
-    return digitalRead(reedSwitchOpenPin);
+    return HalDigitalRead(ReedSwitchOpenPin);
 }
 
 bool CChecks::CheckClosedLimitSwitch()
 {
-    return digitalRead(reedSwitchClosedPin);
-}
-
-bool CChecks::CheckCommandSignalSwitch()
-{
-    return digitalRead(controlSignalPin);
-}
-
-
-bool CChecks::ProcessControlSignal()
-{
-   /* // if we have already received a command signal, don't allow new command until we've gone low first
-    if(CheckCommandSignalSwitch() && !CommandSignalState)
-    {
-        // set true to establish we're processing a command signal
-        CommandSignalState = true;
-        Serial.println("Command Received");
-    }
-    // If the comman signal has gone low and our CommandSignalState is true means we have finished with this command
-    else if(!CheckCommandSignalSwitch())
-    {
-        CommandSignalState = false;
-    }
-
-    return CommandSignalState;*/
-
-    // return the state of the input pin, true means the radio has been triggered, a timer needs to disallow additional checks in main so we don't do this multiple times
-    return CheckCommandSignalSwitch();
+    return HalDigitalRead(ReedSwitchClosedPin);
 }
 
 bool CChecks::CheckClosingLimit()
@@ -71,7 +47,7 @@ bool CChecks::CheckClosingLimit()
             bHasReachedLimit = true;
             GatePosition =  EPosition::Closed;
             LastGatePosition = GatePosition;
-            Serial.println("Reached Closed Position!");
+            Serial.println(F("Reached Closed Position!"));
         }
     }
 
@@ -90,7 +66,7 @@ bool CChecks::CheckOpeningLimit()
             bHasReachedLimit = true;   
             GatePosition = EPosition::Open;
             LastGatePosition = GatePosition;
-            Serial.println("Reached Open Position!");
+            Serial.println(F("Reached Open Position!"));
         }
     }
 
@@ -108,7 +84,7 @@ void CChecks::CheckAndSetCurrentPosition()
        if(GatePosition != LastPositionDebug)
         {
             LastPositionDebug = GatePosition;
-            Serial.println("Gate position unknown!");
+            Serial.println(F("Gate position unknown!"));
         }
         return;
     }
@@ -118,7 +94,7 @@ void CChecks::CheckAndSetCurrentPosition()
         if(GatePosition != LastPositionDebug)
         {
             LastPositionDebug = GatePosition;
-            Serial.println("Gate position open!");
+            Serial.println(F("Gate position open!"));
         }
         return;
     }
@@ -128,7 +104,7 @@ void CChecks::CheckAndSetCurrentPosition()
         if(GatePosition != LastPositionDebug)
         {
             LastPositionDebug = GatePosition;
-            Serial.println("Gate position closed!");
+            Serial.println(F("Gate position closed!"));
         }
         return;
     }    
@@ -138,7 +114,7 @@ void CChecks::CheckAndSetCurrentPosition()
         if(GatePosition != LastPositionDebug)
         {
             LastPositionDebug = GatePosition;
-            Serial.println("Gate position unknown!");
+            Serial.println(F("Gate position unknown!"));
         }
         return;
     }
@@ -1,25 +1,19 @@
-#include "Pins.h"
+#pragma once
+#include "Config.h"
 #include <Arduino.h>
 #include "Enums.h"
+#include "Hal.h"
 
 class CChecks
 {
 public:
-    CChecks();
+    CChecks(uint8_t _ReedSwitchOpenPin, uint8_t _ReedSwitchClosedPin);
     // Queries the state of the Open limit switch - true if high
     bool CheckOpenLimitSwitch();
 
     // Queries the state of the Closed limit switch - true if high
     bool CheckClosedLimitSwitch();
 
-    // Queries the state of the Command Control Pin - returns true if high
-    bool CheckCommandSignalSwitch();
-
-    // Controls when we can return the command signal state to ready to receive
-    // when the command signal is received we say that the state is Active until the command signal goes low again
-    // this is because the signal sent by the receiver module is HIGH for ~1 second
-    bool ProcessControlSignal();
-
     // returns true if we've reached the closed limit switch if we're EMoveDirection::Closing
     bool CheckClosingLimit();
 
@@ -39,7 +33,9 @@ public:
     EPosition LastGatePosition = EPosition::None;
 
 private:
-    bool CommandSignalState = false;
+    // Limit switch pins for the gate this belongs to
+    uint8_t ReedSwitchOpenPin;
+    uint8_t ReedSwitchClosedPin;
 
     // Enum when we know our current position
     EPosition GatePosition = EPosition::None;
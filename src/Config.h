@@ -0,0 +1,168 @@
+#pragma once
+#include <Arduino.h>
+#include "Pins.h"
+
+// Compile time configuration, one profile per installation selected with -DGATE_PROFILE_<name> in platformio.ini.
+// Every tunable the controller uses lives here so a profile is a complete description of one gate,
+// and the static_asserts at the bottom reject a bad profile at build time instead of on the gate.
+
+#ifdef GATE_COUNT
+#error "GATE_COUNT is set by the configuration profile, select a profile with -DGATE_PROFILE_<name> instead"
+#endif
+
+// Values every profile starts from, a profile only lists what it changes
+struct FConfigDefaults
+{
+    //////////////// Pins ///////////////
+
+    typedef FInputPins Inputs;
+    typedef FLeafAPins LeafA;
+    typedef FLeafBPins LeafB;
+
+    //////////////// Features, code behind a disabled feature is removed by the compiler ///////////////
+
+    static constexpr bool bSafetyBeam = false; // a beam must be wired to Inputs::SafetyBeam, an unwired input reads broken
+
+    static constexpr bool bPedestrian = true; // radio double press opens the first leaf part way
+
+    static constexpr bool bThermalModel = true; // queue commands while the estimated motor temperature is too high
+
+    static constexpr bool bDebugLogging = false; // timer and limit button chatter on the serial port
+
+    //////////////// Durations, milliseconds ///////////////
+
+    static constexpr uint32_t BlinkMillis = 500; // LED blink half period while moving
+
+    static constexpr uint32_t DefaultTimeoutMillis = 10000; // motor shutoff used until a travel time has been recorded
+
+    static constexpr uint32_t MinTimeoutMillis = 1000; // recorded travel times outside this range are rejected
+
+    static constexpr uint32_t MaxTimeoutMillis = 240000; // a run this long from a cold motor must stay under ThermalRiseLimitDegrees
+
+    static constexpr uint32_t StaggerMillis = 2000; // delay between leaves, changed at run time with "stagger N"
+
+    static constexpr uint32_t MaxStaggerMillis = 60000;
+
+    static constexpr uint32_t SafetyReverseDeadTimeMillis = 500; // relay off time between a beam stop and the reverse
+
+    static constexpr uint32_t RadioMinPulseMillis = 30; // shorter radio pulses are treated as noise
+
+    static constexpr uint32_t RadioLongPulseMillis = 2000; // held this long a press becomes Stop
+
+    static constexpr uint32_t RadioDoubleGapMillis = 500; // second press within this gap becomes Pedestrian
+
+    //////////////// Other tunables ///////////////
+
+    static constexpr int SetLimitButtonWindowLoops = 100; // loops the limit button waits for its second press
+
+    static constexpr uint32_t SafetyBeamBudgetMicros = 50; // beam break to closing relay off, the benchmark fails past it
+
+    static constexpr uint16_t ThermalHeatMilliDegreesPerSecond = 200; // temperature rise per second of motor run
+
+    static constexpr uint16_t ThermalCoolingTimeConstantSeconds = 600;
+
+    static constexpr uint16_t ThermalRiseLimitDegrees = 50; // rise above ambient where new runs are held back
+
+#ifdef SERIAL_BAUD
+    static constexpr uint32_t SerialBaud = SERIAL_BAUD;
+#else
+    static constexpr uint32_t SerialBaud = 9600;
+#endif
+};
+
+//////////////// Profiles ///////////////
+
+#if defined(GATE_PROFILE_DOUBLE_LEAF)
+
+// Double leaf gate with a photo beam across the gateway
+#define GATE_COUNT 2
+struct FConfig : FConfigDefaults
+{
+    static constexpr uint8_t GateCount = GATE_COUNT;
+
+    static constexpr bool bSafetyBeam = true;
+};
+
+#else
+
+// Single leaf gate, the original board with no safety beam wired
+#define GATE_COUNT 1
+struct FConfig : FConfigDefaults
+{
+    static constexpr uint8_t GateCount = GATE_COUNT;
+};
+
+#endif
+
+//////////////// Validation ///////////////
+
+namespace ConfigCheck
+{
+    constexpr bool PinNotIn(uint8_t)
+    {
+        return true;
+    }
+
+    template <typename... TRest>
+    constexpr bool PinNotIn(uint8_t Pin, uint8_t First, TRest... Rest)
+    {
+        return Pin != First && PinNotIn(Pin, Rest...);
+    }
+
+    constexpr bool PinsDistinct()
+    {
+        return true;
+    }
+
+    template <typename... TRest>
+    constexpr bool PinsDistinct(uint8_t First, TRest... Rest)
+    {
+        return First < NUM_DIGITAL_PINS && PinNotIn(First, Rest...) && PinsDistinct(Rest...);
+    }
+}
+
+#define CONFIG_LEAF_PINS(Leaf) Leaf::OpenLED, Leaf::CloseLED, Leaf::IdleLED, Leaf::RelayOpen, Leaf::RelayClose, Leaf::ReedSwitchClosed, Leaf::ReedSwitchOpen
+
+#if GATE_COUNT > 1
+#define CONFIG_OUTPUT_PINS CONFIG_LEAF_PINS(FConfig::LeafA), CONFIG_LEAF_PINS(FConfig::LeafB)
+#else
+#define CONFIG_OUTPUT_PINS CONFIG_LEAF_PINS(FConfig::LeafA)
+#endif
+
+static_assert(FConfig::GateCount >= 1 && FConfig::GateCount <= 2, "Pins.h only has pin maps for two gate leaves");
+
+static_assert(ConfigCheck::PinsDistinct(FConfig::Inputs::Radio, FConfig::Inputs::SetLimitButton, CONFIG_OUTPUT_PINS),
+              "every pin in the profile must exist on the board and be used once");
+
+static_assert(!FConfig::bSafetyBeam || ConfigCheck::PinNotIn(FConfig::Inputs::SafetyBeam, FConfig::Inputs::Radio, FConfig::Inputs::SetLimitButton, CONFIG_OUTPUT_PINS),
+              "the safety beam pin is shared with another function");
+
+static_assert(digitalPinToInterrupt(FConfig::Inputs::Radio) != NOT_AN_INTERRUPT, "the radio input is decoded from interrupts and must be an interrupt pin");
+
+static_assert(!FConfig::bSafetyBeam || digitalPinToInterrupt(FConfig::Inputs::SafetyBeam) != NOT_AN_INTERRUPT,
+              "the safety beam stops the motor from an interrupt and must be an interrupt pin");
+
+static_assert(FConfig::MinTimeoutMillis > 0 && FConfig::MinTimeoutMillis <= FConfig::DefaultTimeoutMillis &&
+                  FConfig::DefaultTimeoutMillis <= FConfig::MaxTimeoutMillis,
+              "the default timeout must be inside the accepted timeout range");
+
+static_assert(FConfig::MaxTimeoutMillis / 1000 <= 0xFFFF && FConfig::MaxStaggerMillis / 1000 <= 0xFFFF,
+              "durations must fit in FSeconds");
+
+static_assert(FConfig::StaggerMillis <= FConfig::MaxStaggerMillis, "the default stagger must be inside its range");
+
+static_assert(FConfig::BlinkMillis > 0, "the blink period must be non zero");
+
+static_assert(FConfig::RadioMinPulseMillis > 0 && FConfig::RadioMinPulseMillis < FConfig::RadioDoubleGapMillis &&
+                  FConfig::RadioDoubleGapMillis < FConfig::RadioLongPulseMillis,
+              "radio timings must order as noise < double press gap < long press");
+
+static_assert(FConfig::ThermalCoolingTimeConstantSeconds > 0 && FConfig::ThermalRiseLimitDegrees > 0,
+              "thermal model constants must be non zero");
+
+// CanStartRun rounds a run up to the next whole second, a longer timeout would leave the gate unable to move even cold
+static_assert(!FConfig::bThermalModel || (FConfig::MaxTimeoutMillis / 1000 + 1) * FConfig::ThermalHeatMilliDegreesPerSecond < FConfig::ThermalRiseLimitDegrees * 1000UL,
+              "a run of the longest timeout from a cold motor must fit under the thermal limit");
+
+#undef CONFIG_OUTPUT_PINS
+#undef CONFIG_LEAF_PINS
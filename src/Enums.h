@@ -22,4 +22,12 @@ enum class ECommandState
     Ready,
     Acknowledged,
     Processing
-};
\ No newline at end of file
+};
+// Commands decoded from the pulses on the radio input
+enum class ERadioCommand
+{
+    None,
+    Toggle,
+    Stop,
+    Pedestrian
+};
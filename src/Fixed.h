@@ -0,0 +1,141 @@
+#pragma once
+#include <Arduino.h>
+#include "Hal.h"
+
+// Unit tags, a value of one unit can't be passed where another is expected
+struct USeconds {};
+struct UDegrees {};
+
+// Unsigned Q16.16 fixed point value - 16 whole bits and 16 fractional bits
+// all arithmetic saturates instead of wrapping, a bad calibration must never roll a timeout over to zero
+template <typename TUnit>
+class TFixed
+{
+public:
+    static const uint8_t FractionBits = 16;
+    static const uint32_t One = 1UL << FractionBits;
+    static const uint32_t MaxRaw = 0xFFFFFFFFUL;
+
+    TFixed() : Raw(0) {}
+
+    static TFixed FromRaw(uint32_t NewRaw)
+    {
+        TFixed Value;
+        Value.Raw = NewRaw;
+        return Value;
+    }
+
+    static TFixed FromInt(uint16_t Whole) { return FromRaw(static_cast<uint32_t>(Whole) << FractionBits); }
+
+    // e.g. FromRatio(3, 2) is 1.5
+    static TFixed FromRatio(uint16_t Numerator, uint16_t Denominator) { return FromInt(Numerator).Scale(1, Denominator); }
+
+    uint32_t GetRaw() const { return Raw; }
+
+    uint16_t GetWhole() const { return static_cast<uint16_t>(Raw >> FractionBits); }
+
+    // First decimal place, for printing
+    uint8_t GetTenths() const { return static_cast<uint8_t>(((Raw & (One - 1)) * 10) >> FractionBits); }
+
+    bool IsZero() const { return Raw == 0; }
+
+    TFixed operator+(TFixed Other) const { return FromRaw(Raw > MaxRaw - Other.Raw ? MaxRaw : Raw + Other.Raw); }
+
+    // clamps at zero
+    TFixed operator-(TFixed Other) const { return FromRaw(Raw > Other.Raw ? Raw - Other.Raw : 0); }
+
+    // Multiplies by Numerator / Denominator without a 64 bit intermediate, e.g. Scale(11, 10) adds ten percent
+    TFixed Scale(uint16_t Numerator, uint16_t Denominator) const
+    {
+        if (Denominator == 0)
+        {
+            return FromRaw(MaxRaw);
+        }
+
+        uint32_t Whole = Raw / Denominator;
+        uint32_t Remainder = Raw % Denominator;
+
+        if (Numerator != 0 && Whole > MaxRaw / Numerator)
+        {
+            return FromRaw(MaxRaw);
+        }
+
+        // Remainder < Denominator so Remainder * Numerator always fits in 32 bits
+        return FromRaw(Whole * Numerator) + FromRaw((Remainder * Numerator) / Denominator);
+    }
+
+    bool operator==(TFixed Other) const { return Raw == Other.Raw; }
+    bool operator!=(TFixed Other) const { return Raw != Other.Raw; }
+    bool operator<(TFixed Other) const { return Raw < Other.Raw; }
+    bool operator>(TFixed Other) const { return Raw > Other.Raw; }
+    bool operator<=(TFixed Other) const { return Raw <= Other.Raw; }
+    bool operator>=(TFixed Other) const { return Raw >= Other.Raw; }
+
+private:
+    uint32_t Raw;
+};
+
+// Durations in seconds, up to ~18 hours with ~15 microsecond resolution
+typedef TFixed<USeconds> FSeconds;
+
+// Temperatures in degrees C
+typedef TFixed<UDegrees> FDegrees;
+
+// A millis() timestamp or duration, kept as a whole number of milliseconds so it can follow millis() wraparound
+struct FMillis
+{
+    uint32_t Value;
+
+    explicit FMillis(uint32_t NewValue = 0) : Value(NewValue) {}
+
+    // wrap safe as long as the duration is less than ~49 days
+    FMillis Since(FMillis Earlier) const { return FMillis(Value - Earlier.Value); }
+
+    bool operator<(FMillis Other) const { return Value < Other.Value; }
+    bool operator>(FMillis Other) const { return Value > Other.Value; }
+};
+
+// 65536 / 1000 reduces to 8192 / 125, splitting the division keeps everything in 32 bits
+inline FSeconds ToSeconds(FMillis Millis)
+{
+    uint32_t Whole = Millis.Value / 125;
+    uint32_t Remainder = Millis.Value % 125;
+
+    if (Whole > (FSeconds::MaxRaw >> 13))
+    {
+        return FSeconds::FromRaw(FSeconds::MaxRaw);
+    }
+
+    return FSeconds::FromRaw(Whole << 13) + FSeconds::FromRaw((Remainder << 13) / 125);
+}
+
+inline FMillis ToMillis(FSeconds Seconds)
+{
+    uint32_t Whole = static_cast<uint32_t>(Seconds.GetWhole()) * 1000;
+    uint32_t Fraction = ((Seconds.GetRaw() & (FSeconds::One - 1)) * 1000) >> FSeconds::FractionBits;
+    return FMillis(Whole + Fraction);
+}
+
+// Older firmware stored the timeout in EEPROM as a float number of seconds, this reads those bits without pulling in
+// float code. A valid float timeout can't be mistaken for a valid Q16.16 one, 1 second is 0x3F800000 as a float
+// and 0x10000 as Q16.16. Returns zero for anything that was never a usable timeout
+inline FSeconds DecodeLegacyFloatTimeout(uint32_t Bits)
+{
+    uint8_t Exponent = (Bits >> 23) & 0xFF;
+
+    // negative, or outside 1 to 65535 seconds
+    if ((Bits & 0x80000000UL) || Exponent < 127 || Exponent > 127 + 15)
+    {
+        return FSeconds();
+    }
+
+    // value = Mantissa * 2^(Exponent - 150), Q16.16 shifts that up by 16
+    uint32_t Mantissa = (Bits & 0x7FFFFFUL) | 0x800000UL;
+    int8_t Shift = Exponent - 134;
+    return FSeconds::FromRaw(Shift >= 0 ? Mantissa << Shift : Mantissa >> -Shift);
+}
+
+inline FMillis MillisNow()
+{
+    return FMillis(HalMillis());
+}
@@ -0,0 +1,624 @@
+#include "Gate.h"
+#include "EEPROM.h"
+
+// Time between the safety beam dropping the closing relay and the open relay being switched on
+static const FSeconds SafetyReverseDeadTime = ToSeconds(FMillis(FConfig::SafetyReverseDeadTimeMillis));
+
+// true for a timer that exists and is counting, timers behind a disabled feature are never created
+static bool IsTimerRunning(CTimer *Timer)
+{
+    return Timer && Timer->GetTimerState() == ETimerState::Running;
+}
+
+// Anything outside this range read back from EEPROM is treated as uninitialised
+static const FSeconds MinActiveTimeout = ToSeconds(FMillis(FConfig::MinTimeoutMillis));
+static const FSeconds MaxActiveTimeout = ToSeconds(FMillis(FConfig::MaxTimeoutMillis));
+
+CGate::CGate(uint8_t _Index, const FGatePins &_Pins)
+{
+    Index = _Index;
+    Pins = _Pins;
+}
+
+void CGate::Initialize()
+{
+    pinMode(Pins.CloseLED, OUTPUT);
+    pinMode(Pins.RelayClose, OUTPUT);
+    pinMode(Pins.RelayOpen, OUTPUT);
+    pinMode(Pins.OpenLED, OUTPUT);
+    pinMode(Pins.IdleLED, OUTPUT);
+    pinMode(Pins.ReedSwitchClosed, INPUT);
+    pinMode(Pins.ReedSwitchOpen, INPUT);
+
+    StateCheck = new CChecks(Pins.ReedSwitchOpen, Pins.ReedSwitchClosed);
+    GatePolicy = new CGatePolicy();
+
+    BlinkLEDTimer = new CTimer(F("BlinkTimer"));
+    BlinkLEDTimer->SetTimer(ToSeconds(FMillis(FConfig::BlinkMillis)));
+    BlinkLEDTimer->StartTimer();
+
+    // Only created for the features the profile uses, every use checks for null
+    if (FConfig::GateCount > 1)
+    {
+        StaggerTimer = new CTimer(F("StaggerTimer"));
+    }
+
+    if (FConfig::bThermalModel)
+    {
+        Thermal = new CThermalModel();
+    }
+
+    if (FConfig::bSafetyBeam)
+    {
+        SafetyReverseTimer = new CTimer(F("SafetyReverseTimer"));
+        SafetyReverseTimer->SetTimer(SafetyReverseDeadTime);
+    }
+
+    TimeoutTimer = new CTimer(F("TimeoutTimer"));
+    uint32_t getEEPROM = 0;
+    EEPROM.get(GetEEPROMTimeoutMemLoc(), getEEPROM);
+    FSeconds StoredTimeout = FSeconds::FromRaw(getEEPROM);
+    if (StoredTimeout < MinActiveTimeout || StoredTimeout > MaxActiveTimeout)
+    {
+        FSeconds LegacyTimeout = DecodeLegacyFloatTimeout(getEEPROM);
+        if (LegacyTimeout >= MinActiveTimeout && LegacyTimeout <= MaxActiveTimeout)
+        {
+            // rewrite it in the current format so this only happens once
+            StoredTimeout = LegacyTimeout;
+            EEPROM.put(GetEEPROMTimeoutMemLoc(), StoredTimeout.GetRaw());
+            PrintGateName();
+            Serial.println(F("Converted stored timeout from the old format"));
+        }
+    }
+
+    if (StoredTimeout >= MinActiveTimeout && StoredTimeout <= MaxActiveTimeout)
+    {
+        ActiveTimeout = StoredTimeout;
+    }
+    else
+    {
+        PrintGateName();
+        Serial.println(F("Stored timeout invalid, using default"));
+    }
+    TimeoutTimer->SetTimer(ActiveTimeout);
+    TimeoutTimer->SetDebugTimer(false);
+
+    PrintGateName();
+    Serial.print(F("Timeout = "));
+    Serial.print(ActiveTimeout.GetWhole());
+    Serial.println(F(" seconds"));
+}
+
+void CGate::WriteLEDs(bool bOpen, bool bClose, bool bIdle)
+{
+    HalDigitalWrite(Pins.OpenLED, bOpen);
+    HalDigitalWrite(Pins.CloseLED, bClose);
+    HalDigitalWrite(Pins.IdleLED, bIdle);
+}
+
+void CGate::PrintThermal()
+{
+    if (!Thermal)
+    {
+        PrintGateName();
+        Serial.println(F("Thermal model disabled"));
+        return;
+    }
+
+    FDegrees TemperatureRise = Thermal->GetTemperatureRise();
+    PrintGateName();
+    Serial.print(F("Motor temperature rise = "));
+    Serial.print(TemperatureRise.GetWhole());
+    Serial.print(F("."));
+    Serial.print(TemperatureRise.GetTenths());
+    Serial.print(F("C, limit = "));
+    Serial.print(Thermal->GetTemperatureRiseLimit().GetWhole());
+    Serial.println(F("C"));
+}
+
+void CGate::PrintGateName()
+{
+    Serial.print(F("Gate "));
+    Serial.print(Index);
+    Serial.print(F(" - "));
+}
+
+//////////////// Master direction control ///////////////
+void CGate::SetOpening()
+{
+    TimeoutTimer->Reset();
+    TimeoutTimer->StartTimer();
+    if (StaggerTimer)
+    {
+        StaggerTimer->Reset();
+    }
+
+    // Allows gate to run, is set to ready when Idle is triggered by a button press during processing
+    // or when the gate reaches a limit or timeout is triggered
+    CommandState = ECommandState::Processing;
+    GatePolicy->OnGateMoving();
+    if (Thermal)
+    {
+        Thermal->OnMotorStarted();
+    }
+
+    PrintGateName();
+    Serial.println(F("Opening State Set"));
+    StateCheck->SetMovementState(EMoveDirection::Opening);
+    LastMovementDirection = EMoveDirection::Opening;
+    HalDigitalWrite(Pins.OpenLED, HIGH);
+    HalDigitalWrite(Pins.CloseLED, LOW);
+    HalDigitalWrite(Pins.IdleLED, LOW);
+    HalDigitalWrite(Pins.RelayClose, LOW);
+    HalDigitalWrite(Pins.RelayOpen, HIGH);
+}
+
+void CGate::SetClosing()
+{
+    TimeoutTimer->Reset();
+    TimeoutTimer->StartTimer();
+    if (StaggerTimer)
+    {
+        StaggerTimer->Reset();
+    }
+
+    // Allows gate to run, is set to ready when Idle is triggered by a button press during processing
+    // or when the gate reaches a limit or timeout is triggered
+    CommandState = ECommandState::Processing;
+    GatePolicy->OnGateMoving();
+    if (Thermal)
+    {
+        Thermal->OnMotorStarted();
+    }
+
+    PrintGateName();
+    Serial.println(F("Closing State Set"));
+    StateCheck->SetMovementState(EMoveDirection::Closing);
+    LastMovementDirection = EMoveDirection::Closing;
+    HalDigitalWrite(Pins.OpenLED, LOW);
+    HalDigitalWrite(Pins.CloseLED, HIGH);
+    HalDigitalWrite(Pins.IdleLED, LOW);
+    HalDigitalWrite(Pins.RelayOpen, LOW);
+
+    // The beam interrupt only acts on a gate already in the closing state, so check the beam and switch the relay
+    // with interrupts off, otherwise a break between the two would be missed and the relay left on.
+    // A broken beam is handled as if it broke just after the relay was switched on, the next Update stops the gate
+    noInterrupts();
+    if (FConfig::bSafetyBeam && HalDigitalRead(FConfig::Inputs::SafetyBeam))
+    {
+        bSafetyReversePending = true;
+    }
+    if (!bSafetyReversePending)
+    {
+        HalDigitalWrite(Pins.RelayClose, HIGH);
+    }
+    interrupts();
+}
+
+void CGate::SetIdle()
+{
+    TimeoutTimer->Reset();
+    // stopping also cancels a staggered command or a safety reversal that hasn't started yet
+    if (StaggerTimer)
+    {
+        StaggerTimer->Reset();
+    }
+    if (SafetyReverseTimer)
+    {
+        SafetyReverseTimer->Reset();
+    }
+    if (Thermal)
+    {
+        Thermal->OnMotorStopped();
+    }
+    PrintGateName();
+    Serial.println(F("Idle State Set"));
+    StateCheck->SetMovementState(EMoveDirection::Idle);
+    CommandState = ECommandState::Ready;
+    GatePolicy->OnGateStopped(StateCheck->GetGatePosition());
+    HalDigitalWrite(Pins.OpenLED, LOW);
+    HalDigitalWrite(Pins.CloseLED, LOW);
+    HalDigitalWrite(Pins.IdleLED, HIGH);
+    HalDigitalWrite(Pins.RelayClose, LOW);
+    HalDigitalWrite(Pins.RelayOpen, LOW);
+}
+
+///////////////////////////////////////////////////////////
+
+void CGate::StartMove(EMoveDirection Direction)
+{
+    if (StateCheck->GetMoveDirection() == EMoveDirection::Opening || StateCheck->GetMoveDirection() == EMoveDirection::Closing)
+    {
+        return;
+    }
+
+    EPosition Position = StateCheck->GetGatePosition();
+    if ((Direction == EMoveDirection::Opening && Position == EPosition::Open) ||
+        (Direction == EMoveDirection::Closing && Position == EPosition::Closed))
+    {
+        return;
+    }
+
+    // never start closing into something standing in the gateway
+    if (Direction == EMoveDirection::Closing && FConfig::bSafetyBeam && HalDigitalRead(FConfig::Inputs::SafetyBeam))
+    {
+        PrintGateName();
+        Serial.println(F("Safety beam broken, close refused"));
+        return;
+    }
+
+    if (Direction == EMoveDirection::Opening)
+    {
+        SetOpening();
+    }
+    else
+    {
+        SetClosing();
+    }
+
+    // only a run that starts at a limit can be timed as a full cycle
+    if (Position != EPosition::Unknown)
+    {
+        if (bWantsNewTimeoutRecording)
+        {
+            bIsRecordingNewTimeout = true;
+        }
+        StateCheck->LastGatePosition = Position;
+    }
+}
+
+void CGate::QueueMove(EMoveDirection Direction, FSeconds Delay)
+{
+    if (Delay.IsZero() || !StaggerTimer)
+    {
+        StartMove(Direction);
+        return;
+    }
+
+    QueuedDirection = Direction;
+    StaggerTimer->Reset();
+    StaggerTimer->SetTimer(Delay);
+    StaggerTimer->StartTimer();
+}
+
+void CGate::PedestrianAction()
+{
+    if (!GatePolicy->IsPedestrianEnabled())
+    {
+        Serial.println(F("Pedestrian mode disabled"));
+        return;
+    }
+
+    if (StateCheck->GetMoveDirection() != EMoveDirection::Idle || StateCheck->GetGatePosition() != EPosition::Closed)
+    {
+        Serial.println(F("Pedestrian opening only allowed from closed"));
+        return;
+    }
+
+    if (!CanStartRun())
+    {
+        Serial.println(F("Motor hot, pedestrian opening refused"));
+        return;
+    }
+
+    SetOpening();
+    StateCheck->LastGatePosition = EPosition::Closed;
+    GatePolicy->StartPedestrian(ActiveTimeout);
+}
+
+void CGate::OnSafetyBeamBroken()
+{
+    if (StateCheck->GetMoveDirection() == EMoveDirection::Closing)
+    {
+        HalDigitalWrite(Pins.RelayClose, LOW);
+        bSafetyReversePending = true;
+    }
+}
+
+void CGate::SafetyReverse()
+{
+    if (!SafetyReverseTimer)
+    {
+        return;
+    }
+
+    if (IsTimerRunning(StaggerTimer) && QueuedDirection == EMoveDirection::Closing)
+    {
+        StaggerTimer->Reset();
+        PrintGateName();
+        Serial.println(F("Safety beam broken, queued close cancelled"));
+    }
+
+    if (StateCheck->GetMoveDirection() != EMoveDirection::Closing)
+    {
+        return;
+    }
+
+    HalDigitalWrite(Pins.RelayClose, LOW);
+    PrintGateName();
+    Serial.println(F("Safety beam broken while closing! Reversing"));
+    bIsRecordingNewTimeout = false;
+    SetIdle();
+    SafetyReverseTimer->Reset();
+    SafetyReverseTimer->StartTimer();
+}
+
+bool CGate::IsSafetyReversing()
+{
+    return IsTimerRunning(SafetyReverseTimer);
+}
+
+bool CGate::IsMoving()
+{
+    return StateCheck->GetMoveDirection() == EMoveDirection::Opening || StateCheck->GetMoveDirection() == EMoveDirection::Closing ||
+           IsTimerRunning(StaggerTimer) || IsTimerRunning(SafetyReverseTimer);
+}
+
+bool CGate::CanStartRun()
+{
+    return !Thermal || Thermal->CanStartRun(ActiveTimeout);
+}
+
+unsigned long CGate::GetIdleMillis()
+{
+    if (StateCheck->GetMoveDirection() == EMoveDirection::Opening || StateCheck->GetMoveDirection() == EMoveDirection::Closing ||
+        IsTimerRunning(StaggerTimer) || IsTimerRunning(SafetyReverseTimer) ||
+        GatePolicy->IsActive())
+    {
+        return 0;
+    }
+
+    // the thermal model only needs its tick, a command queued on a hot motor waits for it to cool
+    if (Thermal && Thermal->IsTicking())
+    {
+        return CThermalModel::TickMillis;
+    }
+
+    return 0xFFFFFFFFUL;
+}
+
+void CGate::RecordNewActiveTimeout()
+{
+    FSeconds NewSoftwareLimitTime = ToSeconds(MillisNow().Since(TemporaryTimeoutRecording));
+
+    // Add ten percent to make sure we don't cut off too early
+    FSeconds NewActiveTimeout = NewSoftwareLimitTime.Scale(11, 10);
+
+    // a longer value would be rejected as invalid on the next boot
+    if (NewActiveTimeout > MaxActiveTimeout)
+    {
+        NewActiveTimeout = MaxActiveTimeout;
+    }
+
+    // Only save larger value to prevent short stops in operation
+    if (NewActiveTimeout > ActiveTimeout)
+    {
+        ActiveTimeout = NewActiveTimeout;
+        TimeoutTimer->SetTimer(ActiveTimeout);
+
+        TemporaryTimeoutRecording = FMillis(0);
+        EEPROM.put(GetEEPROMTimeoutMemLoc(), ActiveTimeout.GetRaw());
+
+        PrintGateName();
+        Serial.print(F("Saving new timeout(ms) = "));
+        Serial.println(ToMillis(ActiveTimeout).Value);
+    }
+    else
+    {
+        Serial.print(F("New Timeout Shorter than Existing, discarding new timeout value..."));
+    }
+
+    bHasRecordedStartTime = false;
+    bWantsNewTimeoutRecording = false;
+}
+
+void CGate::BlinkPositionLED()
+{
+    // blink the open or close position LED's while awaiting command
+    if (BlinkLEDTimer->GetTimerState() == ETimerState::Complete)
+    {
+        BlinkLEDTimer->Reset();
+
+        if (StateCheck->GetGatePosition() == EPosition::Closed)
+        {
+            HalDigitalWrite(Pins.OpenLED, LOW);
+            HalDigitalWrite(Pins.IdleLED, LOW);
+            HalDigitalWrite(Pins.CloseLED, !HalDigitalRead(Pins.CloseLED));
+        }
+        else if (StateCheck->GetGatePosition() == EPosition::Open)
+        {
+            HalDigitalWrite(Pins.CloseLED, LOW);
+            HalDigitalWrite(Pins.IdleLED, LOW);
+            HalDigitalWrite(Pins.OpenLED, !HalDigitalRead(Pins.OpenLED));
+        }
+        else if (StateCheck->GetGatePosition() == EPosition::Unknown)
+        {
+            HalDigitalWrite(Pins.CloseLED, LOW);
+            HalDigitalWrite(Pins.OpenLED, LOW);
+            HalDigitalWrite(Pins.IdleLED, !HalDigitalRead(Pins.IdleLED));
+        }
+    }
+}
+
+EPolicyAction CGate::Update(bool bRadioHeld, bool bBeamBroken)
+{
+    TimeoutTimer->Update();
+    BlinkLEDTimer->Update();
+
+    // The safety beam interrupt has already dropped the closing relay, stop properly and wait out the dead time
+    if (FConfig::bSafetyBeam && bSafetyReversePending)
+    {
+        bSafetyReversePending = false;
+        SafetyReverse();
+        return EPolicyAction::None;
+    }
+
+    if (IsTimerRunning(SafetyReverseTimer))
+    {
+        SafetyReverseTimer->Update();
+
+        if (SafetyReverseTimer->GetTimerState() == ETimerState::Complete)
+        {
+            SafetyReverseTimer->Reset();
+            SetOpening();
+        }
+    }
+
+    if (Thermal)
+    {
+        Thermal->Update();
+    }
+
+    // A staggered command is waiting for its delay
+    if (IsTimerRunning(StaggerTimer))
+    {
+        StaggerTimer->Update();
+
+        if (StaggerTimer->GetTimerState() == ETimerState::Complete)
+        {
+            StaggerTimer->Reset();
+            StartMove(QueuedDirection);
+        }
+    }
+
+    // Set the gate position every frame, used to process movement directions and what to do if we're not at a limit switch
+    StateCheck->CheckAndSetCurrentPosition();
+
+    // Auto close and pedestrian stops, costs nothing unless a policy is pending
+    EPolicyAction PolicyAction = EPolicyAction::None;
+    if (GatePolicy->IsActive())
+    {
+        PolicyAction = GatePolicy->Update(bRadioHeld, bBeamBroken);
+
+        if (PolicyAction == EPolicyAction::Stop)
+        {
+            SetIdle();
+            return EPolicyAction::None;
+        }
+    }
+
+    // Blink LED if Idle and at a limit
+    if (StateCheck->GetMoveDirection() == EMoveDirection::Idle)
+    {
+        BlinkPositionLED();
+    }
+
+    //////////////// The gate is actioning the last command here ////////////////////////
+
+    // Motor protection timeout is handled here - shuts off motor if the timer reaches completion
+    // Set Idle returns the timer state to None, allowing a new start timer to occur with each command received
+    if (TimeoutTimer->GetTimerState() == ETimerState::Complete)
+    {
+        // Run the timeout while processing
+        if (!bIsRecordingNewTimeout || !bWantsNewTimeoutRecording)
+        {
+            PrintGateName();
+            if (StateCheck->GetMoveDirection() == EMoveDirection::Opening)
+            {
+                Serial.println(F("Opening Timed Out"));
+            }
+            else if (StateCheck->GetMoveDirection() == EMoveDirection::Closing)
+            {
+                Serial.println(F("Closing Timed Out"));
+            }
+
+            SetIdle();
+            return PolicyAction;
+        }
+    }
+
+    // if the gate is currently operating
+    if (CommandState == ECommandState::Processing)
+    {
+        // check to see if we've reached the open position
+        switch (StateCheck->GetMoveDirection())
+        {
+        case EMoveDirection::Opening:
+
+            // Runs if we're setting a new timeout
+            if (bIsRecordingNewTimeout)
+            {
+                if (!bHasRecordedStartTime)
+                {
+                    bHasRecordedStartTime = true;
+                    TemporaryTimeoutRecording = MillisNow(); //get the current "time" (actually the number of milliseconds since the program started)
+                    if (FConfig::bDebugLogging)
+                    {
+                        Serial.print(F("Start Time = "));
+                        Serial.println(TemporaryTimeoutRecording.Value);
+                    }
+                }
+
+                if (FConfig::bDebugLogging)
+                {
+                    Serial.print(F("Setting new timeout - elapsed time(seconds) = "));
+                    Serial.println(ToSeconds(MillisNow().Since(TemporaryTimeoutRecording)).GetWhole());
+                }
+            }
+
+            if (StateCheck->GetGatePosition() == EPosition::Open)
+            {
+                // Reached open position while opening
+                PrintGateName();
+                Serial.println(F("Open position reached! Set IDLE"));
+
+                // we have completed a full opening cycle, record the new value if significantly different
+                // from previous recordings
+                if (bIsRecordingNewTimeout)
+                {
+                    bIsRecordingNewTimeout = false;
+                    RecordNewActiveTimeout();
+                }
+
+                SetIdle();
+            }
+            break;
+
+        case EMoveDirection::Closing:
+            if (bIsRecordingNewTimeout)
+            {
+                if (!bHasRecordedStartTime)
+                {
+                    bHasRecordedStartTime = true;
+                    TemporaryTimeoutRecording = MillisNow(); //get the current "time" (actually the number of milliseconds since the program started)
+                    if (FConfig::bDebugLogging)
+                    {
+                        Serial.print(F("Start Time = "));
+                        Serial.println(TemporaryTimeoutRecording.Value);
+                    }
+                }
+            }
+
+            if (StateCheck->GetGatePosition() == EPosition::Closed)
+            {
+                // Reached closed position while closing
+                PrintGateName();
+                Serial.println(F("Closed position reached! Set IDLE"));
+
+                // we have completed a full closing cycle, record the new value
+                if (bIsRecordingNewTimeout)
+                {
+                    bIsRecordingNewTimeout = false;
+                    RecordNewActiveTimeout();
+                }
+
+                SetIdle();
+            }
+            break;
+
+        case EMoveDirection::Idle:
+            // If we're already idle, stay idle.
+            if (FConfig::bDebugLogging)
+            {
+                Serial.println(F("Already Idle, gate must have been stopped manually or timed out."));
+            }
+            break;
+
+        default:
+            Serial.println(F("Error: Default case. Set IDLE"));
+            SetIdle();
+        }
+    }
+
+    return PolicyAction;
+}
@@ -0,0 +1,151 @@
+#pragma once
+#include <Arduino.h>
+#include "Enums.h"
+#include "Checks.h"
+#include "Timer.h"
+#include "Policy.h"
+#include "Fixed.h"
+#include "Thermal.h"
+
+// Pin numbers a gate needs at runtime, filled in from a pin map by TGate
+struct FGatePins
+{
+    uint8_t OpenLED;
+    uint8_t CloseLED;
+    uint8_t IdleLED;
+    uint8_t RelayOpen;
+    uint8_t RelayClose;
+    uint8_t ReedSwitchClosed;
+    uint8_t ReedSwitchOpen;
+};
+
+// A single gate leaf - its movement state, timers and learned timeout
+// The logic lives here rather than in TGate so it is only compiled once however many pin maps are used
+class CGate
+{
+public:
+    CGate(uint8_t _Index, const FGatePins &_Pins);
+
+    // Sets the pin modes, reads the learned timeout back from EEPROM and creates the timers
+    void Initialize();
+
+    //////////////// Master direction control ///////////////
+    void SetOpening();
+
+    void SetClosing();
+
+    void SetIdle();
+
+    // Moves a stopped gate in Direction, does nothing if it's moving or already at that limit
+    void StartMove(EMoveDirection Direction);
+
+    // Runs StartMove(Direction) once Delay has elapsed, a zero delay runs it immediately
+    void QueueMove(EMoveDirection Direction, FSeconds Delay);
+
+    // Opens the gate for a fraction of the learned travel time, only from the closed position
+    void PedestrianAction();
+
+    // Safe to call from an interrupt - if the gate is closing the closing relay is dropped immediately,
+    // the next Update stops the gate properly and reopens it once SafetyReverseDeadTime has passed
+    void OnSafetyBeamBroken();
+
+    // Stops a closing gate and reopens it once SafetyReverseDeadTime has passed, and cancels a close still waiting
+    // for its stagger. Called for every leaf once one of them reverses, so the whole gate reverses together
+    void SafetyReverse();
+
+    // true while waiting out the dead time before reopening after the safety beam
+    bool IsSafetyReversing();
+
+    // The next full open or close cycle will be timed and saved as the new timeout
+    void RequestTimeoutRecording() { bWantsNewTimeoutRecording = true; };
+
+    // Runs the gate for one loop, returns EPolicyAction::Close when the auto close wants the gates shut
+    EPolicyAction Update(bool bRadioHeld, bool bBeamBroken);
+
+    // true while the motor is running or a staggered or safety reversal command is waiting to run
+    bool IsMoving();
+
+    // true if the motor is cool enough for a run of the learned travel time
+    bool CanStartRun();
+
+    // How long the gate can go without an Update before it has something to do, 0 while anything is pending
+    // the simulation uses this to skip idle time
+    unsigned long GetIdleMillis();
+
+    EPosition GetGatePosition() { return StateCheck->GetGatePosition(); };
+
+    // Prints the motor temperature estimate
+    void PrintThermal();
+
+    // Used to flash the LEDs of every gate together as feedback
+    void WriteLEDs(bool bOpen, bool bClose, bool bIdle);
+
+    CGatePolicy *GetPolicy() { return GatePolicy; };
+
+private:
+    uint8_t Index;
+    FGatePins Pins;
+
+    CChecks *StateCheck = nullptr;
+    EMoveDirection LastMovementDirection{EMoveDirection::Idle};
+    ECommandState CommandState = ECommandState::Ready;
+    bool bWantsNewTimeoutRecording = false;
+
+    // value stored in EEProm which updates when a full open or close cycle completes
+    // ensures the motor doesn't stay on in the case of a failure with one of the
+    // limit switches... prevents motor overheat
+    // stored as the raw Q16.16 value so no float code is pulled in
+    FSeconds ActiveTimeout = ToSeconds(FMillis(FConfig::DefaultTimeoutMillis));
+
+    bool bHasRecordedStartTime = false;
+    // save any attempts here, if we complete a full cycle we update ActiveTimeout
+    FMillis TemporaryTimeoutRecording{};
+    // will become true whenever button is pressed and then the gate opens or closes from an open or closed position
+    // will then become false if a cycle completes (in which case we update) or fails (in which case we disregard)
+    bool bIsRecordingNewTimeout = false;
+
+    // Blink the closed or open LED while closing or opening
+    CTimer *BlinkLEDTimer = nullptr;
+    CTimer *TimeoutTimer = nullptr;
+
+    // Delays a command so the leaves of a double gate don't start together, null with a single leaf
+    CTimer *StaggerTimer = nullptr;
+    EMoveDirection QueuedDirection{EMoveDirection::Idle};
+
+    // Set by the safety beam interrupt, handled in Update
+    volatile bool bSafetyReversePending = false;
+
+    // Lets the motor stop before it's reversed after the safety beam stopped it, null without a beam
+    CTimer *SafetyReverseTimer = nullptr;
+
+    // Motor winding temperature estimate, a command that would overheat the motor waits in main until it has cooled
+    // null with the thermal model disabled, every run is then allowed
+    CThermalModel *Thermal = nullptr;
+
+    // Auto close, hold open and pedestrian opening, configured over serial
+    CGatePolicy *GatePolicy = nullptr;
+
+    int GetEEPROMTimeoutMemLoc() { return Index * sizeof(uint32_t); };
+
+    void RecordNewActiveTimeout();
+
+    void BlinkPositionLED();
+
+    // Prints which gate a message comes from
+    void PrintGateName();
+};
+
+// A gate built from a pin map such as FLeafAPins, checks the pin map at compile time
+template <typename TPins>
+class TGate : public CGate
+{
+public:
+    TGate(uint8_t _Index)
+        : CGate(_Index, FGatePins{TPins::OpenLED, TPins::CloseLED, TPins::IdleLED, TPins::RelayOpen, TPins::RelayClose,
+                                  TPins::ReedSwitchClosed, TPins::ReedSwitchOpen})
+    {
+    }
+
+    static_assert(TPins::RelayOpen != TPins::RelayClose, "Open and close relays must use different pins");
+    static_assert(TPins::ReedSwitchOpen != TPins::ReedSwitchClosed, "Open and closed reed switches must use different pins");
+};
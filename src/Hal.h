@@ -0,0 +1,62 @@
+#pragma once
+#include <Arduino.h>
+
+// Every pin, interrupt and clock access made by the gate logic goes through these, so that with GATE_SIMULATION defined
+// a simulated plant stands in for the gate, reed switches and radio while the rest of the firmware runs unchanged
+#ifdef GATE_SIMULATION
+#include "Config.h"
+#include "Simulation.h"
+
+inline int HalDigitalRead(uint8_t Pin)
+{
+    return Simulation->DigitalRead(Pin);
+}
+
+inline bool HalIsLEDPin(uint8_t Pin)
+{
+    return Pin == FConfig::LeafA::OpenLED || Pin == FConfig::LeafA::CloseLED || Pin == FConfig::LeafA::IdleLED ||
+           (FConfig::GateCount > 1 && (Pin == FConfig::LeafB::OpenLED || Pin == FConfig::LeafB::CloseLED || Pin == FConfig::LeafB::IdleLED));
+}
+
+// Only the LEDs are mirrored to the real pins, so they show what the simulated gate is doing. The relays never are,
+// a board running the simulation ignores its real reed switches and would drive a wired motor into its end stops
+inline void HalDigitalWrite(uint8_t Pin, uint8_t Value)
+{
+    Simulation->DigitalWrite(Pin, Value);
+    if (HalIsLEDPin(Pin))
+    {
+        digitalWrite(Pin, Value);
+    }
+}
+
+inline unsigned long HalMillis()
+{
+    return Simulation->GetMillis();
+}
+
+// The simulation calls the handler itself when it changes the pin
+inline void HalAttachInterrupt(uint8_t Pin, void (*Handler)(), int Mode)
+{
+    Simulation->AttachInterrupt(Pin, Handler, Mode);
+}
+#else
+inline int HalDigitalRead(uint8_t Pin)
+{
+    return digitalRead(Pin);
+}
+
+inline void HalDigitalWrite(uint8_t Pin, uint8_t Value)
+{
+    digitalWrite(Pin, Value);
+}
+
+inline unsigned long HalMillis()
+{
+    return millis();
+}
+
+inline void HalAttachInterrupt(uint8_t Pin, void (*Handler)(), int Mode)
+{
+    attachInterrupt(digitalPinToInterrupt(Pin), Handler, Mode);
+}
+#endif
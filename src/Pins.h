@@ -1,19 +1,51 @@
 #pragma once
+#include <Arduino.h>
 
-#define openLEDPin 7 // LED on when gate is EMoveDirection::Opening
+//////////////// Inputs shared by every gate, sampled once per loop ///////////////
 
-#define closeLEDPin 6 // LED on when gate is EMoveDirection::Closing
+struct FInputPins
+{
+    static const uint8_t Radio = 3; // 5V is passed to this pin when the relay on the receiver is triggered by a controller, HIGH is received for ~1 second
 
-#define idleLEDPin 5 // LED on when gate is idle
+    static const uint8_t SafetyBeam = 2; // photo beam or safety edge, NC contact to ground with the internal pullup so a broken beam or a cut wire reads HIGH, must be an interrupt pin
 
-#define controlSignalPin 3 // 5V is passed to this pin when the relay on the receiver is triggered by a controller, HIGH is received for ~1 second
+    static const uint8_t SetLimitButton = 4; // pin that when LOW sets the software limit mode, where a new software motor shutoff will be calculated
+};
 
-#define relayControlOpenPin 11 // Pin that controls the SSR, gate will open when HIGH (pulled LOW);
+//////////////// Per gate pin maps, passed to TGate as its template parameter ///////////////
 
-#define relayControlClosePin 13 // Pin that controls the SSR, gate will close when HIGH (pulled LOW);
+// Single gate, or the first leaf of a double gate - the leaf that opens first and closes last
+struct FLeafAPins
+{
+    static const uint8_t OpenLED = 7; // LED on when gate is EMoveDirection::Opening
 
-#define reedSwitchClosedPin 10 // Pin that when high indicates the closed position has been reached
+    static const uint8_t CloseLED = 6; // LED on when gate is EMoveDirection::Closing
 
-#define reedSwitchOpenPin 9 // Pin that when high indicates the open position has been reached
+    static const uint8_t IdleLED = 5; // LED on when gate is idle
 
-#define setSoftwareLimitSwitch 4 // pin that when LOW sets the software limit mode, where a new software motor shutoff will be calculated
\ No newline at end of file
+    static const uint8_t RelayOpen = 11; // Pin that controls the SSR, gate will open when HIGH (pulled LOW);
+
+    static const uint8_t RelayClose = 13; // Pin that controls the SSR, gate will close when HIGH (pulled LOW);
+
+    static const uint8_t ReedSwitchClosed = 10; // Pin that when high indicates the closed position has been reached
+
+    static const uint8_t ReedSwitchOpen = 9; // Pin that when high indicates the open position has been reached
+};
+
+// Second leaf of a double gate, uses the analog header as digital pins so pin 2 stays free for an interrupt input
+struct FLeafBPins
+{
+    static const uint8_t OpenLED = A2;
+
+    static const uint8_t CloseLED = A3;
+
+    static const uint8_t IdleLED = A4;
+
+    static const uint8_t RelayOpen = 12;
+
+    static const uint8_t RelayClose = 8;
+
+    static const uint8_t ReedSwitchClosed = A1;
+
+    static const uint8_t ReedSwitchOpen = A0;
+};
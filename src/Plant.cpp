@@ -0,0 +1,189 @@
+#include "Plant.h"
+
+#ifdef GATE_SIMULATION
+
+CGatePlant::CGatePlant(uint8_t _RelayOpenPin, uint8_t _RelayClosePin, uint8_t _ReedSwitchOpenPin, uint8_t _ReedSwitchClosedPin)
+{
+    RelayOpenPin = _RelayOpenPin;
+    RelayClosePin = _RelayClosePin;
+    ReedSwitchOpenPin = _ReedSwitchOpenPin;
+    ReedSwitchClosedPin = _ReedSwitchClosedPin;
+
+    // start at rest against the closed end stop, not mid bounce
+    ReedOpenChangeMillis = BounceMillis;
+    ReedClosedChangeMillis = BounceMillis;
+}
+
+void CGatePlant::InjectObstruction(long NewPosition)
+{
+    bObstructed = true;
+    ObstructionPosition = NewPosition;
+}
+
+unsigned int CGatePlant::GetCurrentmA()
+{
+    if (!IsMotorOn())
+    {
+        return 0;
+    }
+
+    return bStalled ? StallCurrentmA : RunningCurrentmA;
+}
+
+void CGatePlant::ResetStats()
+{
+    Runs = 0;
+    LimitStops = 0;
+    MidTravelStops = 0;
+    ObstructedStops = 0;
+    RelayConflicts = 0;
+    MotorOnMillis = 0;
+    StalledMillis = 0;
+    PeakCurrentmA = 0;
+    ChargemAs = 0;
+    ChargeRemainder = 0;
+    RestGapTotal = 0;
+    RestGapCount = 0;
+}
+
+void CGatePlant::OnMotorStopped()
+{
+    if (bStalled && bObstructed)
+    {
+        ObstructedStops++;
+    }
+    else if (bReedOpen || bReedClosed)
+    {
+        LimitStops++;
+        bAwaitingRest = true;
+    }
+    else
+    {
+        MidTravelStops++;
+    }
+
+    // the obstruction is cleared once the motor stops, the next run is free to move
+    bObstructed = false;
+}
+
+void CGatePlant::Step(uint8_t *Pins, unsigned long StepMillis)
+{
+    bool bRelayOpen = Pins[RelayOpenPin];
+    bool bRelayClose = Pins[RelayClosePin];
+
+    // Both relays on would short the motor windings, the motor doesn't move
+    if (bRelayOpen && bRelayClose)
+    {
+        RelayConflicts++;
+        bRelayOpen = false;
+        bRelayClose = false;
+    }
+
+    int8_t NewDirection = bRelayOpen ? 1 : (bRelayClose ? -1 : 0);
+    if (NewDirection != MotorDirection)
+    {
+        if (MotorDirection != 0)
+        {
+            OnMotorStopped();
+        }
+        if (NewDirection != 0)
+        {
+            Runs++;
+            bAwaitingRest = false;
+        }
+        MotorDirection = NewDirection;
+    }
+
+    // Motor inertia, accelerate towards full speed while powered and coast down while not
+    long FullSpeed = (PositionOpen - PositionClosed) / static_cast<long>(TravelMillis);
+    long TargetVelocity = FullSpeed * MotorDirection;
+    long Acceleration = (FullSpeed * static_cast<long>(StepMillis)) / static_cast<long>(MotorDirection != 0 ? SpinUpMillis : CoastMillis);
+    if (Acceleration < 1)
+    {
+        Acceleration = 1;
+    }
+
+    if (Velocity < TargetVelocity)
+    {
+        Velocity = min(Velocity + Acceleration, TargetVelocity);
+    }
+    else if (Velocity > TargetVelocity)
+    {
+        Velocity = max(Velocity - Acceleration, TargetVelocity);
+    }
+
+    long NewPosition = Position + Velocity * static_cast<long>(StepMillis);
+
+    // Obstructions and the end stops block the leaf
+    bStalled = false;
+    if (bObstructed && ((Velocity > 0 && Position <= ObstructionPosition && NewPosition > ObstructionPosition) ||
+                        (Velocity < 0 && Position >= ObstructionPosition && NewPosition < ObstructionPosition)))
+    {
+        NewPosition = ObstructionPosition;
+    }
+    if (NewPosition >= PositionOpen)
+    {
+        NewPosition = PositionOpen;
+    }
+    if (NewPosition <= PositionClosed)
+    {
+        NewPosition = PositionClosed;
+    }
+    if (NewPosition == Position && Velocity != 0)
+    {
+        Velocity = 0;
+        bStalled = MotorDirection != 0;
+    }
+    Position = NewPosition;
+
+    if (MotorDirection != 0)
+    {
+        MotorOnMillis += StepMillis;
+        if (bStalled)
+        {
+            StalledMillis += StepMillis;
+        }
+
+        unsigned int CurrentmA = GetCurrentmA();
+        if (CurrentmA > PeakCurrentmA)
+        {
+            PeakCurrentmA = CurrentmA;
+        }
+        ChargeRemainder += static_cast<unsigned long>(CurrentmA) * StepMillis;
+        ChargemAs += ChargeRemainder / 1000;
+        ChargeRemainder %= 1000;
+    }
+
+    if (bAwaitingRest && Velocity == 0)
+    {
+        bAwaitingRest = false;
+        RestGapTotal += (Position - PositionClosed < PositionOpen - Position) ? Position - PositionClosed : PositionOpen - Position;
+        RestGapCount++;
+    }
+
+    Pins[ReedSwitchOpenPin] = ReadReedSwitch(Position >= PositionOpen - ReedSwitchRange, bReedOpen, ReedOpenChangeMillis, StepMillis);
+    Pins[ReedSwitchClosedPin] = ReadReedSwitch(Position <= PositionClosed + ReedSwitchRange, bReedClosed, ReedClosedChangeMillis, StepMillis);
+}
+
+uint8_t CGatePlant::ReadReedSwitch(bool bIdeal, bool &bLastIdeal, unsigned long &ChangeMillis, unsigned long StepMillis)
+{
+    if (bIdeal != bLastIdeal)
+    {
+        bLastIdeal = bIdeal;
+        ChangeMillis = 0;
+    }
+    else if (ChangeMillis < BounceMillis)
+    {
+        ChangeMillis += StepMillis;
+    }
+
+    // contacts bounce for a short while after the magnet crosses the switch
+    if (ChangeMillis < BounceMillis)
+    {
+        return random(2);
+    }
+
+    return bIdeal ? HIGH : LOW;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+#include <Arduino.h>
+
+// Simulated gate leaf, only built with GATE_SIMULATION
+// An AC motor with spin up and coast drives the leaf between two end stops, the reed switches are noisy and bounce
+// It reads the relay outputs the firmware writes and produces the reed switch inputs the firmware reads
+class CGatePlant
+{
+public:
+    // Leaf position, closed end stop to open end stop
+    static const long PositionClosed = 0;
+    static const long PositionOpen = 10000000L;
+
+    CGatePlant(uint8_t _RelayOpenPin, uint8_t _RelayClosePin, uint8_t _ReedSwitchOpenPin, uint8_t _ReedSwitchClosedPin);
+
+    // Advances the model by StepMillis, reading the relays from and writing the reed switches to Pins
+    void Step(uint8_t *Pins, unsigned long StepMillis);
+
+    // The next run is blocked at Position until the motor is switched off
+    void InjectObstruction(long Position);
+
+    long GetPosition() { return Position; };
+
+    // true while the leaf is closing and within Distance of an obstruction, used to break the safety beam
+    bool IsClosingOnObstruction(long Distance)
+    {
+        return bObstructed && MotorDirection < 0 && Position >= ObstructionPosition && Position - ObstructionPosition <= Distance;
+    };
+
+    bool IsMotorOn() { return MotorDirection != 0; };
+
+    // true once the motor is off, the leaf has stopped and the reed switches have settled, Step then changes nothing
+    bool IsAtRest() { return MotorDirection == 0 && Velocity == 0 && ReedOpenChangeMillis >= BounceMillis && ReedClosedChangeMillis >= BounceMillis; };
+
+    // Estimated motor current, stall current while the leaf is blocked or pushing against an end stop
+    unsigned int GetCurrentmA();
+
+    // Clears the statistics below
+    void ResetStats();
+
+    //////////////// Tunables ///////////////
+    unsigned long TravelMillis = 8000;
+    // Time to reach full speed from rest and to coast to rest from full speed
+    unsigned long SpinUpMillis = 400;
+    unsigned long CoastMillis = 300;
+    unsigned int RunningCurrentmA = 2500;
+    unsigned int StallCurrentmA = 6000;
+    // The reed switch closes this far from its end stop
+    long ReedSwitchRange = PositionOpen / 100;
+    // Readings are random for this long after the magnet crosses the switch
+    unsigned long BounceMillis = 20;
+
+    //////////////// Statistics ///////////////
+    unsigned long Runs = 0;
+    unsigned long LimitStops = 0;
+    unsigned long MidTravelStops = 0;
+    unsigned long ObstructedStops = 0;
+    unsigned long RelayConflicts = 0;
+    unsigned long MotorOnMillis = 0;
+    // Motor on while the leaf can't move, the firmware's timeout decides how long this gets
+    unsigned long StalledMillis = 0;
+    // Motor current, sampled every step
+    unsigned int PeakCurrentmA = 0;
+    unsigned long ChargemAs = 0;
+    // Sum of the distance from the end stop the leaf came to rest at after a limit stop
+    unsigned long RestGapTotal = 0;
+    unsigned long RestGapCount = 0;
+
+private:
+    uint8_t RelayOpenPin;
+    uint8_t RelayClosePin;
+    uint8_t ReedSwitchOpenPin;
+    uint8_t ReedSwitchClosedPin;
+
+    long Position = PositionClosed;
+    // Position units per millisecond, signed
+    long Velocity = 0;
+    // 1 opening, -1 closing, 0 off
+    int8_t MotorDirection = 0;
+
+    bool bObstructed = false;
+    long ObstructionPosition = 0;
+    bool bStalled = false;
+
+    // true after a run until the leaf has coasted to rest
+    bool bAwaitingRest = false;
+
+    // Charge below a whole mAs carried over to the next step, in mA milliseconds
+    unsigned long ChargeRemainder = 0;
+
+    // The last ideal reed switch readings and how long ago they changed, for bounce
+    bool bReedOpen = false;
+    bool bReedClosed = true;
+    unsigned long ReedOpenChangeMillis = 0;
+    unsigned long ReedClosedChangeMillis = 0;
+
+    void OnMotorStopped();
+
+    uint8_t ReadReedSwitch(bool bIdeal, bool &bLastIdeal, unsigned long &ChangeMillis, unsigned long StepMillis);
+};
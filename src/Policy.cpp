@@ -0,0 +1,142 @@
+#include "Policy.h"
+#include "SerialCommand.h"
+
+CGatePolicy::CGatePolicy()
+{
+    AutoCloseTimer = new CTimer(F("AutoCloseTimer"));
+
+    if (FConfig::bPedestrian)
+    {
+        PedestrianTimer = new CTimer(F("PedestrianTimer"));
+    }
+}
+
+void CGatePolicy::OnGateMoving()
+{
+    bAutoCloseArmed = false;
+    bPedestrianRunning = false;
+    AutoCloseTimer->Reset();
+    if (PedestrianTimer)
+    {
+        PedestrianTimer->Reset();
+    }
+}
+
+void CGatePolicy::OnGateStopped(EPosition Position)
+{
+    // a pedestrian opening stops between the limit switches, so still counts as open
+    bool bIsOpen = Position == EPosition::Open || bPedestrianRunning;
+
+    bPedestrianRunning = false;
+    if (PedestrianTimer)
+    {
+        PedestrianTimer->Reset();
+    }
+
+    if (bIsOpen && !AutoCloseTime.IsZero())
+    {
+        bAutoCloseArmed = true;
+        AutoCloseTimer->Reset();
+        AutoCloseTimer->SetTimer(AutoCloseTime);
+        AutoCloseTimer->StartTimer();
+        Serial.print(F("Auto close in "));
+        Serial.print(AutoCloseTime.GetWhole());
+        Serial.println(F(" seconds"));
+    }
+}
+
+void CGatePolicy::StartPedestrian(FSeconds TravelTime)
+{
+    if (!PedestrianTimer)
+    {
+        return;
+    }
+
+    bPedestrianRunning = true;
+    PedestrianTimer->Reset();
+    PedestrianTimer->SetTimer(TravelTime.Scale(PedestrianPercent, 100));
+    PedestrianTimer->StartTimer();
+}
+
+EPolicyAction CGatePolicy::Update(bool bRadioHeld, bool bBeamBroken)
+{
+    if (bPedestrianRunning && PedestrianTimer)
+    {
+        PedestrianTimer->Update();
+
+        if (PedestrianTimer->GetTimerState() == ETimerState::Complete)
+        {
+            Serial.println(F("Pedestrian opening complete"));
+            return EPolicyAction::Stop;
+        }
+    }
+
+    if (bAutoCloseArmed)
+    {
+        // While the radio is held past a long press we keep the gate open, the countdown restarts when it's released
+        if ((bHoldOpenEnabled && bRadioHeld) || bBeamBroken)
+        {
+            AutoCloseTimer->Reset();
+            return EPolicyAction::None;
+        }
+
+        if (AutoCloseTimer->GetTimerState() == ETimerState::None)
+        {
+            AutoCloseTimer->StartTimer();
+        }
+
+        AutoCloseTimer->Update();
+
+        if (AutoCloseTimer->GetTimerState() == ETimerState::Complete)
+        {
+            bAutoCloseArmed = false;
+            AutoCloseTimer->Reset();
+            Serial.println(F("Auto close triggered"));
+            return EPolicyAction::Close;
+        }
+    }
+
+    return EPolicyAction::None;
+}
+
+bool CGatePolicy::HandleSerialCommand(const String &Command)
+{
+    long Value = 0;
+    if (MatchSerialCommand(Command, "autoclose", Value))
+    {
+        AutoCloseTime = FSeconds::FromInt(Value > 0xFFFF ? 0xFFFF : Value);
+
+        // changing the setting cancels any countdown already running
+        if (AutoCloseTime.IsZero())
+        {
+            bAutoCloseArmed = false;
+            AutoCloseTimer->Reset();
+        }
+    }
+    else if (MatchSerialCommand(Command, "holdopen", Value))
+    {
+        bHoldOpenEnabled = Value != 0;
+    }
+    else if (FConfig::bPedestrian && MatchSerialCommand(Command, "pedestrian", Value))
+    {
+        PedestrianPercent = Value > 100 ? 100 : Value;
+    }
+    else
+    {
+        return false;
+    }
+
+    PrintSettings();
+    return true;
+}
+
+void CGatePolicy::PrintSettings()
+{
+    Serial.print(F("Policy - autoclose = "));
+    Serial.print(AutoCloseTime.GetWhole());
+    Serial.print(F("s, holdopen = "));
+    Serial.print(bHoldOpenEnabled);
+    Serial.print(F(", pedestrian = "));
+    Serial.print(PedestrianPercent);
+    Serial.println(F("%"));
+}
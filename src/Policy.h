@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+#include "Enums.h"
+#include "Timer.h"
+#include "Config.h"
+
+// What the policy engine wants the gate to do this frame
+enum class EPolicyAction
+{
+    None,
+    Close,
+    Stop
+};
+
+class CGatePolicy
+{
+public:
+    CGatePolicy();
+
+    // Called whenever the gate starts moving, disarms any pending auto close
+    void OnGateMoving();
+
+    // Called whenever the gate is set idle, arms the auto close if we stopped open or after a pedestrian opening
+    void OnGateStopped(EPosition Position);
+
+    // Starts a pedestrian opening, the gate will be stopped after PedestrianPercent of the learned travel time
+    // must be called after the gate has been set opening
+    void StartPedestrian(FSeconds TravelTime);
+
+    // Only needs to be called while IsActive() returns true, returns the action the gate should take
+    // the auto close countdown is held while the safety beam is broken or, with hold open, while bRadioHeld
+    EPolicyAction Update(bool bRadioHeld, bool bBeamBroken);
+
+    // true if there is an auto close or pedestrian stop pending
+    bool IsActive() { return bAutoCloseArmed || bPedestrianRunning; };
+
+    // Parses a serial command, returns false if the command isn't a policy command
+    // autoclose <seconds>  - close the gate after being open for <seconds>, 0 disables
+    // holdopen <0|1>       - hold the gate open while the radio is held past a long press, the long press's Stop
+    //                        does nothing to a gate that isn't moving
+    // pedestrian <percent> - percentage of the learned travel time a pedestrian opening runs for
+    bool HandleSerialCommand(const String &Command);
+
+    bool IsPedestrianEnabled() { return FConfig::bPedestrian && PedestrianPercent > 0; };
+
+private:
+    CTimer *AutoCloseTimer = nullptr;
+    CTimer *PedestrianTimer = nullptr; // only created when FConfig::bPedestrian is set
+
+    // Time the gate waits while open before closing, 0 disables auto close
+    FSeconds AutoCloseTime{};
+
+    // Percentage of the learned travel time used for a pedestrian opening, 0 disables pedestrian mode
+    uint8_t PedestrianPercent = 0;
+
+    bool bHoldOpenEnabled = false;
+    bool bAutoCloseArmed = false;
+    bool bPedestrianRunning = false;
+
+    void PrintSettings();
+};
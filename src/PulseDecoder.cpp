@@ -0,0 +1,169 @@
+#include "PulseDecoder.h"
+#include "Hal.h"
+
+// The decoder the pin change interrupt feeds
+static CPulseDecoder *AttachedDecoder = nullptr;
+
+CPulseDecoder::CPulseDecoder(uint8_t _InputPin)
+{
+    InputPin = _InputPin;
+}
+
+void CPulseDecoder::Begin()
+{
+    AttachedDecoder = this;
+    bHigh = HalDigitalRead(InputPin);
+    HalAttachInterrupt(InputPin, OnPinChange, CHANGE);
+}
+
+void CPulseDecoder::OnPinChange()
+{
+    AttachedDecoder->PushEdge(HalDigitalRead(AttachedDecoder->InputPin), HalMillis());
+}
+
+void CPulseDecoder::PushEdge(bool bRising, unsigned long Millis)
+{
+    uint8_t NextHead = (EdgeHead + 1) % EdgeBufferSize;
+
+    // a full buffer drops the newest edge, which could be the one that ends a press, so Update resyncs from the pin
+    if (NextHead == EdgeTail)
+    {
+        bEdgeOverflow = true;
+        return;
+    }
+
+    Edges[EdgeHead].Millis = Millis;
+    Edges[EdgeHead].bRising = bRising;
+    EdgeHead = NextHead;
+}
+
+bool CPulseDecoder::PopEdge(FEdge &Edge)
+{
+    bool bHasEdge = false;
+
+    noInterrupts();
+    if (EdgeTail != EdgeHead)
+    {
+        Edge.Millis = Edges[EdgeTail].Millis;
+        Edge.bRising = Edges[EdgeTail].bRising;
+        EdgeTail = (EdgeTail + 1) % EdgeBufferSize;
+        bHasEdge = true;
+    }
+    interrupts();
+
+    return bHasEdge;
+}
+
+ERadioCommand CPulseDecoder::DecodeEdge(const FEdge &Edge)
+{
+    // bounce can give two edges the same way, only changes matter
+    if (Edge.bRising == bHigh)
+    {
+        return ERadioCommand::None;
+    }
+
+    bHigh = Edge.bRising;
+
+    if (bHigh)
+    {
+        RiseMillis = Edge.Millis;
+        bLongSent = false;
+
+        // the gap was too long for a double press, the last pulse was a single press
+        if (ShortPulseCount == 1 && RiseMillis - LastFallMillis >= DoubleGapMillis)
+        {
+            ShortPulseCount = 0;
+            return ERadioCommand::Toggle;
+        }
+        return ERadioCommand::None;
+    }
+
+    unsigned long Width = Edge.Millis - RiseMillis;
+
+    // noise, or a long press that was sent while the input was still high
+    if (Width < MinPulseMillis || bLongSent)
+    {
+        return ERadioCommand::None;
+    }
+
+    // both edges were buffered before Update saw the press, the width still says what it was
+    if (Width >= LongPulseMillis)
+    {
+        ShortPulseCount = 0;
+        return ERadioCommand::Stop;
+    }
+
+    if (!bDoublePressEnabled)
+    {
+        return ERadioCommand::Toggle;
+    }
+
+    ShortPulseCount++;
+    LastFallMillis = Edge.Millis;
+
+    if (ShortPulseCount >= 2)
+    {
+        ShortPulseCount = 0;
+        return ERadioCommand::Pedestrian;
+    }
+
+    return ERadioCommand::None;
+}
+
+void CPulseDecoder::Resync()
+{
+    noInterrupts();
+    EdgeTail = EdgeHead;
+    bEdgeOverflow = false;
+    bHigh = HalDigitalRead(InputPin);
+    interrupts();
+
+    // the pulses seen so far are incomplete, a press still held counts from now
+    RiseMillis = HalMillis();
+    bLongSent = false;
+    ShortPulseCount = 0;
+}
+
+ERadioCommand CPulseDecoder::Update()
+{
+    ERadioCommand Command = ERadioCommand::None;
+
+    FEdge Edge;
+    while (Command == ERadioCommand::None && PopEdge(Edge))
+    {
+        Command = DecodeEdge(Edge);
+    }
+
+    if (Command != ERadioCommand::None)
+    {
+        return Command;
+    }
+
+    // every edge that fitted has been decoded, the ones that didn't are lost
+    if (bEdgeOverflow)
+    {
+        Resync();
+        return ERadioCommand::None;
+    }
+
+    unsigned long Now = HalMillis();
+
+    // every buffered edge has been decoded here, so the input really is still high
+    if (bHigh)
+    {
+        if (!bLongSent && Now - RiseMillis >= LongPulseMillis)
+        {
+            bLongSent = true;
+            ShortPulseCount = 0;
+            return ERadioCommand::Stop;
+        }
+    }
+    else if (ShortPulseCount == 1 && Now - LastFallMillis >= DoubleGapMillis)
+    {
+        // no second pulse came, it was a single press
+        ShortPulseCount = 0;
+        return ERadioCommand::Toggle;
+    }
+
+    return ERadioCommand::None;
+}
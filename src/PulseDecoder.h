@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+#include "Enums.h"
+#include "Config.h"
+
+// Decodes commands from the length and number of pulses on the radio input
+//   short pulse  - Toggle, sent when the pulse ends
+//   long pulse   - Stop, sent once the input has been held for LongPulseMillis, or when a pulse that was buffered
+//                  whole turns out to have been that long
+//   two short pulses within DoubleGapMillis - Pedestrian, only while double presses are enabled,
+//                  a single short pulse then waits for the gap to pass before sending Toggle
+// Pulses are classified by their timestamped width, so a press is never sent as Toggle before it could become Stop
+// Edges are timestamped by a pin change interrupt so the pulse widths don't depend on loop timing, and a new command
+// is accepted from the next rising edge rather than after a fixed cooldown
+class CPulseDecoder
+{
+public:
+    // Pulses shorter than this are noise
+    static const unsigned long MinPulseMillis = FConfig::RadioMinPulseMillis;
+    static const unsigned long LongPulseMillis = FConfig::RadioLongPulseMillis;
+    static const unsigned long DoubleGapMillis = FConfig::RadioDoubleGapMillis;
+
+    CPulseDecoder(uint8_t _InputPin);
+
+    // Attaches the pin change interrupt, only one decoder can be attached
+    void Begin();
+
+    // Called every loop, returns the command decoded since the last call
+    ERadioCommand Update();
+
+    // true while the input is high
+    bool IsHigh() { return bHigh; };
+
+    // true while the input is held past a long press, the press will never become a Toggle
+    bool IsLongHeld() { return bHigh && bLongSent; };
+
+    // true when there is no press in progress or waiting to be decoded
+    bool IsIdle() { return !bHigh && ShortPulseCount == 0 && EdgeHead == EdgeTail; };
+
+    void SetDoublePressEnabled(bool bEnabled) { bDoublePressEnabled = bEnabled; };
+
+private:
+    struct FEdge
+    {
+        unsigned long Millis;
+        bool bRising;
+    };
+
+    // Edges waiting to be decoded, written by the interrupt and read by Update
+    static const uint8_t EdgeBufferSize = 8;
+    volatile FEdge Edges[EdgeBufferSize];
+    volatile uint8_t EdgeHead = 0;
+    volatile uint8_t EdgeTail = 0;
+    // Set by the interrupt when an edge didn't fit, Update then resyncs from the pin
+    volatile bool bEdgeOverflow = false;
+
+    uint8_t InputPin;
+    bool bDoublePressEnabled = false;
+
+    bool bHigh = false;
+    unsigned long RiseMillis = 0;
+    unsigned long LastFallMillis = 0;
+    bool bLongSent = false;
+    uint8_t ShortPulseCount = 0;
+
+    static void OnPinChange();
+
+    void PushEdge(bool bRising, unsigned long Millis);
+
+    bool PopEdge(FEdge &Edge);
+
+    ERadioCommand DecodeEdge(const FEdge &Edge);
+
+    // Drops whatever was buffered and restarts decoding from the current state of the pin
+    void Resync();
+};
@@ -0,0 +1,46 @@
+#include "SafetyBeam.h"
+#include "Hal.h"
+
+// The beam the interrupt acts on
+static CSafetyBeam *AttachedBeam = nullptr;
+
+CSafetyBeam::CSafetyBeam(uint8_t _InputPin, CGate **_Gates, uint8_t _GateCount)
+{
+    InputPin = _InputPin;
+    Gates = _Gates;
+    GateCount = _GateCount;
+}
+
+void CSafetyBeam::Begin()
+{
+    AttachedBeam = this;
+    pinMode(InputPin, INPUT_PULLUP);
+    HalAttachInterrupt(InputPin, OnBeamBroken, RISING);
+}
+
+bool CSafetyBeam::IsBroken()
+{
+    return HalDigitalRead(InputPin);
+}
+
+void CSafetyBeam::OnBeamBroken()
+{
+    // Kept to pin writes and flags, no serial or timers from an interrupt
+    for (uint8_t i = 0; i < AttachedBeam->GateCount; i++)
+    {
+        AttachedBeam->Gates[i]->OnSafetyBeamBroken();
+    }
+}
+
+void CSafetyBeam::Update()
+{
+    if (!IsBroken())
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < GateCount; i++)
+    {
+        Gates[i]->OnSafetyBeamBroken();
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <Arduino.h>
+#include "Gate.h"
+
+// Photo beam or safety edge across the gateway, shared by every gate
+// A broken beam raises the highest priority external interrupt, which drops the closing relay of every closing gate
+// straight away - the gates then stop and reverse from their next Update, after the relay dead time
+class CSafetyBeam
+{
+public:
+    CSafetyBeam(uint8_t _InputPin, CGate **_Gates, uint8_t _GateCount);
+
+    // Sets the pin mode and attaches the interrupt, only one beam can be attached
+    void Begin();
+
+    // true while the beam is broken
+    bool IsBroken();
+
+    // Called every loop while the beam is broken, so a gate told to close while the beam was already broken
+    // is stopped as well
+    void Update();
+
+private:
+    uint8_t InputPin;
+    CGate **Gates;
+    uint8_t GateCount;
+
+    static void OnBeamBroken();
+};
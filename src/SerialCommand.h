@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+
+// Longest serial command kept, anything past this up to the next newline is discarded so noise on the line
+// can't grow the command buffer into the stack
+const uint8_t MaxSerialCommandLength = 32;
+
+// Matches a "<Name> <number>" serial command in place, without the heap copies substring would make
+// returns false if Command is some other command, otherwise sets Value with negative numbers read as 0
+inline bool MatchSerialCommand(const String &Command, const char *Name, long &Value)
+{
+    size_t NameLength = strlen(Name);
+    const char *Text = Command.c_str();
+    if (strncmp(Text, Name, NameLength) != 0 || Text[NameLength] != ' ')
+    {
+        return false;
+    }
+
+    Value = atol(Text + NameLength + 1);
+    if (Value < 0)
+    {
+        Value = 0;
+    }
+    return true;
+}
@@ -0,0 +1,285 @@
+#include "Simulation.h"
+#include "SerialCommand.h"
+
+#ifdef GATE_SIMULATION
+
+// One simulated day between statistics prints
+static const unsigned long StatsIntervalMillis = 86400000UL;
+
+// The receiver holds its output high for about a second per press
+static const unsigned long PressMillis = 1000;
+
+// An obstruction breaks the safety beam while a closing leaf is this close to it
+static const long BeamDistance = CGatePlant::PositionOpen / 20;
+
+CSimulation *Simulation = nullptr;
+
+CSimulation::CSimulation()
+{
+    Plants[0] = new CGatePlant(FConfig::LeafA::RelayOpen, FConfig::LeafA::RelayClose, FConfig::LeafA::ReedSwitchOpen, FConfig::LeafA::ReedSwitchClosed);
+#if GATE_COUNT > 1
+    Plants[1] = new CGatePlant(FConfig::LeafB::RelayOpen, FConfig::LeafB::RelayClose, FConfig::LeafB::ReedSwitchOpen, FConfig::LeafB::ReedSwitchClosed);
+#endif
+
+    // a zero step only sets the reed switches so the gates start out closed
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+        Plants[i]->Step(Pins, 0);
+    }
+
+    // an intact beam pulls its input low
+    Pins[FConfig::Inputs::SafetyBeam] = LOW;
+
+    NextStatsMillis = StatsIntervalMillis;
+    ScheduleNextPress();
+}
+
+void CSimulation::ScheduleNextPress()
+{
+    if (TrafficIntervalSeconds == 0)
+    {
+        return;
+    }
+
+    // uniform around the average, never closer than the press itself
+    NextPressMillis = NowMillis + PressMillis + random(TrafficIntervalSeconds * 2000);
+}
+
+void CSimulation::AttachInterrupt(uint8_t Pin, void (*Handler)(), int Mode)
+{
+    if (InterruptCount < MaxInterrupts)
+    {
+        Interrupts[InterruptCount].Pin = Pin;
+        Interrupts[InterruptCount].Mode = Mode;
+        Interrupts[InterruptCount].Handler = Handler;
+        InterruptCount++;
+    }
+}
+
+void CSimulation::DriveInput(uint8_t Pin, uint8_t Value)
+{
+    if (Pin >= SimulatedPinCount || Pins[Pin] == Value)
+    {
+        return;
+    }
+
+    Pins[Pin] = Value;
+
+    // the firmware has an input to act on, whatever it said about being idle no longer holds
+    AllowedSkipMillis = 0;
+
+    for (uint8_t i = 0; i < InterruptCount; i++)
+    {
+        FInterrupt &Interrupt = Interrupts[i];
+        if (Interrupt.Pin == Pin && (Interrupt.Mode == CHANGE || (Interrupt.Mode == RISING && Value) || (Interrupt.Mode == FALLING && !Value)))
+        {
+            Interrupt.Handler();
+        }
+    }
+}
+
+void CSimulation::UpdateTraffic()
+{
+    if (bPressHeld && HasPassed(PressReleaseMillis))
+    {
+        DriveInput(FConfig::Inputs::Radio, LOW);
+        bPressHeld = false;
+    }
+
+    if (TrafficIntervalSeconds != 0 && HasPassed(NextPressMillis))
+    {
+        DriveInput(FConfig::Inputs::Radio, HIGH);
+        bPressHeld = true;
+        PressReleaseMillis = NowMillis + PressMillis;
+        ScheduleNextPress();
+    }
+}
+
+void CSimulation::UpdateSafetyBeam()
+{
+    bool bBroken = false;
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+        if (Plants[i]->IsClosingOnObstruction(BeamDistance))
+        {
+            bBroken = true;
+        }
+    }
+
+    if (bBroken == static_cast<bool>(Pins[FConfig::Inputs::SafetyBeam]))
+    {
+        return;
+    }
+
+    if (!bBroken)
+    {
+        DriveInput(FConfig::Inputs::SafetyBeam, LOW);
+        return;
+    }
+
+    BeamBreaks++;
+
+    unsigned long StartMicros = micros();
+    DriveInput(FConfig::Inputs::SafetyBeam, HIGH);
+    unsigned long ReactionMicros = micros() - StartMicros;
+
+    if (ReactionMicros > BeamReactionMicrosMax)
+    {
+        BeamReactionMicrosMax = ReactionMicros;
+    }
+}
+
+unsigned long CSimulation::GetAdvanceMillis()
+{
+    unsigned long SkipMillis = AllowedSkipMillis;
+    AllowedSkipMillis = 0;
+
+    if (SkipMillis <= StepMillis || bPressHeld)
+    {
+        return StepMillis;
+    }
+
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+        if (!Plants[i]->IsAtRest())
+        {
+            return StepMillis;
+        }
+    }
+
+    // stop at the next press or statistics print so they happen on time
+    unsigned long ToStats = NextStatsMillis - NowMillis;
+    if (SkipMillis > ToStats)
+    {
+        SkipMillis = ToStats;
+    }
+    if (TrafficIntervalSeconds != 0 && SkipMillis > NextPressMillis - NowMillis)
+    {
+        SkipMillis = NextPressMillis - NowMillis;
+    }
+
+    return SkipMillis > StepMillis ? SkipMillis : StepMillis;
+}
+
+void CSimulation::Step()
+{
+    if (bPaused)
+    {
+        return;
+    }
+
+    unsigned long AdvanceMillis = GetAdvanceMillis();
+    NowMillis += AdvanceMillis;
+
+    UpdateTraffic();
+
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+        Plants[i]->Step(Pins, AdvanceMillis);
+
+        // a new run has started, maybe block it somewhere along its travel
+        if (Plants[i]->Runs != LastRuns[i])
+        {
+            LastRuns[i] = Plants[i]->Runs;
+            if (random(100) < ObstructionChancePercent)
+            {
+                Plants[i]->InjectObstruction(random(CGatePlant::PositionClosed, CGatePlant::PositionOpen));
+            }
+        }
+    }
+
+    if (FConfig::bSafetyBeam)
+    {
+        UpdateSafetyBeam();
+    }
+
+    if (HasPassed(NextStatsMillis))
+    {
+        NextStatsMillis += StatsIntervalMillis;
+        SimulatedDays++;
+        PrintStats();
+
+        if (StopAfterDays != 0 && SimulatedDays >= StopAfterDays)
+        {
+            Serial.flush();
+            exit(0);
+        }
+    }
+}
+
+void CSimulation::PrintStats()
+{
+    // one line per leaf, comma separated so the log can be loaded straight into a spreadsheet
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+        CGatePlant *Plant = Plants[i];
+        Serial.print(F("SIM,"));
+        Serial.print(SimulatedDays);
+        Serial.print(F(","));
+        Serial.print(i);
+        Serial.print(F(",runs="));
+        Serial.print(Plant->Runs);
+        Serial.print(F(",limit="));
+        Serial.print(Plant->LimitStops);
+        Serial.print(F(",mid="));
+        Serial.print(Plant->MidTravelStops);
+        Serial.print(F(",obstructed="));
+        Serial.print(Plant->ObstructedStops);
+        Serial.print(F(",conflicts="));
+        Serial.print(Plant->RelayConflicts);
+        Serial.print(F(",motor_on_s="));
+        Serial.print(Plant->MotorOnMillis / 1000);
+        Serial.print(F(",stalled_ms="));
+        Serial.print(Plant->StalledMillis);
+        Serial.print(F(",peak_ma="));
+        Serial.print(Plant->PeakCurrentmA);
+        Serial.print(F(",charge_mah="));
+        Serial.print(Plant->ChargemAs / 3600);
+        // stop accuracy, average distance from the end stop in thousandths of the travel
+        Serial.print(F(",rest_gap_permille="));
+        Serial.println(Plant->RestGapCount > 0 ? (Plant->RestGapTotal / Plant->RestGapCount) / (CGatePlant::PositionOpen / 1000) : 0);
+    }
+
+    Serial.print(F("SIMBEAM,"));
+    Serial.print(SimulatedDays);
+    Serial.print(F(",breaks="));
+    Serial.print(BeamBreaks);
+    Serial.print(F(",max_reaction_us="));
+    Serial.println(BeamReactionMicrosMax);
+}
+
+bool CSimulation::HandleSerialCommand(const String &Command)
+{
+    if (Command == "simstats")
+    {
+        PrintStats();
+        return true;
+    }
+
+    long Value = 0;
+    if (MatchSerialCommand(Command, "simstep", Value))
+    {
+        StepMillis = Value < 1 ? 1 : (Value > 20 ? 20 : Value);
+    }
+    else if (MatchSerialCommand(Command, "simtraffic", Value))
+    {
+        TrafficIntervalSeconds = Value;
+        ScheduleNextPress();
+    }
+    else if (MatchSerialCommand(Command, "simobstruct", Value))
+    {
+        ObstructionChancePercent = Value > 100 ? 100 : Value;
+    }
+    else if (MatchSerialCommand(Command, "simdays", Value))
+    {
+        StopAfterDays = Value;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "Plant.h"
+
+// Number of pins the simulation keeps a state for, covers the Uno digital and analog header
+const uint8_t SimulatedPinCount = 20;
+
+// Closed loop simulation, only built with GATE_SIMULATION
+// Owns a simulated clock, one CGatePlant per gate leaf and random radio traffic, and prints statistics every simulated day
+// The clock advances a fixed step per loop rather than following millis(), so time runs many times faster than real time,
+// and while the firmware and the plants are idle it skips straight to the next thing that can happen
+class CSimulation
+{
+public:
+    CSimulation();
+
+    // Called once at the start of every loop, advances the clock and the plants by one step
+    void Step();
+
+    // Called at the end of every loop, the firmware has nothing to do for MaxSkipMillis unless an input changes
+    // the next Step may then skip up to that far ahead if the plants are at rest too
+    void AllowSkip(unsigned long MaxSkipMillis) { AllowedSkipMillis = MaxSkipMillis; };
+
+    unsigned long GetMillis() { return NowMillis; };
+
+    int DigitalRead(uint8_t Pin) { return Pin < SimulatedPinCount ? Pins[Pin] : LOW; };
+
+    void DigitalWrite(uint8_t Pin, uint8_t Value)
+    {
+        if (Pin < SimulatedPinCount)
+        {
+            Pins[Pin] = Value;
+        }
+    };
+
+    // Sets an input the firmware reads, calling its interrupt handler like the hardware would
+    void DriveInput(uint8_t Pin, uint8_t Value);
+
+    // Stands in for attachInterrupt, Mode is RISING, FALLING or CHANGE
+    void AttachInterrupt(uint8_t Pin, void (*Handler)(), int Mode);
+
+    // Parses a serial command, returns false if the command isn't a simulation command
+    // simstep <ms>        - simulated milliseconds per loop
+    // simtraffic <s>      - average seconds between radio presses, 0 stops the traffic
+    // simobstruct <%>     - chance each run is blocked part way
+    // simdays <n>         - stops after n simulated days, 0 runs forever
+    // simstats            - prints the statistics now
+    bool HandleSerialCommand(const String &Command);
+
+    // While paused Step() does nothing, the benchmarks use this to set the pins by hand
+    void SetPaused(bool bNewPaused) { bPaused = bNewPaused; };
+
+private:
+    bool bPaused = false;
+
+    struct FInterrupt
+    {
+        uint8_t Pin;
+        int Mode;
+        void (*Handler)();
+    };
+
+    static const uint8_t MaxInterrupts = 4;
+    FInterrupt Interrupts[MaxInterrupts] = {};
+    uint8_t InterruptCount = 0;
+
+    uint8_t Pins[SimulatedPinCount] = {};
+    CGatePlant *Plants[GATE_COUNT] = {};
+
+    // Times are compared with HasPassed so the simulated clock can run past the 49 day millis() wrap
+    unsigned long NowMillis = 0;
+    unsigned long StepMillis = 1;
+    unsigned long AllowedSkipMillis = 0;
+
+    unsigned long TrafficIntervalSeconds = 120;
+    unsigned long NextPressMillis = 0;
+    unsigned long PressReleaseMillis = 0;
+    bool bPressHeld = false;
+    uint8_t ObstructionChancePercent = 5;
+
+    // Safety beam breaks from obstructions in the path of a closing leaf, and the longest time the beam
+    // interrupt took to return, which is when the closing relay has dropped. Only a rough figure, on the host
+    // it's wall clock time, the budget is enforced in cycles by the beam_to_relay_off benchmark
+    unsigned long BeamBreaks = 0;
+    unsigned long BeamReactionMicrosMax = 0;
+
+    unsigned long NextStatsMillis = 0;
+    unsigned long SimulatedDays = 0;
+    unsigned long StopAfterDays = 0;
+
+    // Runs seen on each plant last step, to spot the start of a new run
+    unsigned long LastRuns[GATE_COUNT] = {};
+
+    bool HasPassed(unsigned long Millis) { return static_cast<long>(NowMillis - Millis) >= 0; };
+
+    // How far the clock can move this step
+    unsigned long GetAdvanceMillis();
+
+    void UpdateTraffic();
+
+    void UpdateSafetyBeam();
+
+    void ScheduleNextPress();
+
+    void PrintStats();
+};
+
+extern CSimulation *Simulation;
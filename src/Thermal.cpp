@@ -0,0 +1,101 @@
+#include "Thermal.h"
+#include "Config.h"
+
+// Defaults give roughly a 40% sustainable duty cycle, in line with S3 rated gate motors
+static const FDegrees HeatPerSecond = FDegrees::FromRatio(FConfig::ThermalHeatMilliDegreesPerSecond, 1000);
+static const uint16_t CoolingTimeConstantSeconds = FConfig::ThermalCoolingTimeConstantSeconds;
+static const FDegrees TemperatureRiseLimit = FDegrees::FromInt(FConfig::ThermalRiseLimitDegrees);
+
+CThermalModel::CThermalModel()
+{
+    TickTimer = new CTimer(F("ThermalTimer"));
+    TickTimer->SetTimer(ToSeconds(FMillis(TickMillis)));
+}
+
+void CThermalModel::OnMotorStarted()
+{
+    if (bMotorOn)
+    {
+        return;
+    }
+
+    bMotorOn = true;
+    MotorStartTime = MillisNow();
+
+    if (TickTimer->GetTimerState() == ETimerState::None)
+    {
+        TickTimer->StartTimer();
+    }
+}
+
+void CThermalModel::OnMotorStopped()
+{
+    if (!bMotorOn)
+    {
+        return;
+    }
+
+    bMotorOn = false;
+    UnaccountedOnTime = FMillis(UnaccountedOnTime.Value + MillisNow().Since(MotorStartTime).Value);
+}
+
+void CThermalModel::Update()
+{
+    if (TickTimer->GetTimerState() == ETimerState::None)
+    {
+        return;
+    }
+
+    TickTimer->Update();
+
+    if (TickTimer->GetTimerState() == ETimerState::Complete)
+    {
+        TickTimer->Reset();
+        Tick();
+
+        // stop ticking once there's nothing left to cool
+        if (bMotorOn || !TemperatureRise.IsZero())
+        {
+            TickTimer->StartTimer();
+        }
+    }
+}
+
+void CThermalModel::Tick()
+{
+    // Motor on time since the last tick, including the part of a run that's still going
+    FMillis OnTime = UnaccountedOnTime;
+    UnaccountedOnTime = FMillis(0);
+    if (bMotorOn)
+    {
+        FMillis Now = MillisNow();
+        OnTime = FMillis(OnTime.Value + Now.Since(MotorStartTime).Value);
+        MotorStartTime = Now;
+    }
+
+    // A late tick can't be more than a few seconds of heat, clamp so Scale's 16 bit arguments are safe
+    uint16_t OnMillis = OnTime.Value > 60000 ? 60000 : static_cast<uint16_t>(OnTime.Value);
+    FDegrees Heat = HeatPerSecond.Scale(OnMillis, 1000);
+
+    // Exponential cooling, one second's worth of T / tau
+    FDegrees Cooling = TemperatureRise.Scale(1, CoolingTimeConstantSeconds);
+    if (Cooling.IsZero())
+    {
+        // too small to decay any further, call it cold
+        Cooling = TemperatureRise;
+    }
+
+    TemperatureRise = TemperatureRise - Cooling + Heat;
+}
+
+FDegrees CThermalModel::GetTemperatureRiseLimit()
+{
+    return TemperatureRiseLimit;
+}
+
+bool CThermalModel::CanStartRun(FSeconds RunTime)
+{
+    // round the run up to a whole second
+    FDegrees RunHeat = HeatPerSecond.Scale(RunTime.GetWhole() + 1, 1);
+    return TemperatureRise + RunHeat <= TemperatureRiseLimit;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+#include "Fixed.h"
+#include "Timer.h"
+
+// First order thermal estimate of the motor winding, as a temperature rise above ambient
+// Heats at a fixed rate while the motor is on and cools exponentially towards ambient, updated once a second
+// from the measured motor on time
+class CThermalModel
+{
+public:
+    CThermalModel();
+
+    void OnMotorStarted();
+
+    void OnMotorStopped();
+
+    // Called every loop, does nothing until the once a second tick and nothing at all once the motor is cold and off
+    void Update();
+
+    static const unsigned long TickMillis = 1000;
+
+    // true while the once a second tick is running
+    bool IsTicking() { return TickTimer->GetTimerState() != ETimerState::None; };
+
+    // true if a run lasting RunTime would keep the estimate under TemperatureRiseLimit
+    bool CanStartRun(FSeconds RunTime);
+
+    FDegrees GetTemperatureRise() { return TemperatureRise; };
+
+    FDegrees GetTemperatureRiseLimit();
+
+private:
+    FDegrees TemperatureRise{};
+
+    CTimer *TickTimer = nullptr;
+
+    bool bMotorOn = false;
+    FMillis MotorStartTime{};
+    // Motor on time not yet turned into heat
+    FMillis UnaccountedOnTime{};
+
+    void Tick();
+};
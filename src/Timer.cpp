@@ -1,19 +1,20 @@
 #include "Timer.h"
+#include "Config.h"
 
-CTimer::CTimer(String _TimerName)
+CTimer::CTimer(const __FlashStringHelper *_TimerName)
 {
     TimerName = _TimerName;
 };
 
-void CTimer::SetTimer(float Seconds)
+void CTimer::SetTimer(FSeconds Seconds)
 {
-    RunTime = static_cast<unsigned long>(Seconds);
+    RunTime = ToMillis(Seconds);
 }
 
 void CTimer::StartTimer()
 {
     TimerState = ETimerState::Running;
-    StartTime = millis();
+    StartTime = MillisNow();
 }
 
 void CTimer::Pause()
@@ -24,14 +25,15 @@ void CTimer::Pause()
 void CTimer::Resume()
 {
     TimerState = ETimerState::Running;
-    StartTime = millis() + ElapsedTimeSeconds;
+    // move the start back by the time we'd already run so the pause isn't counted
+    StartTime = FMillis(MillisNow().Value - ElapsedTime.Value);
     Update();
 }
 
 void CTimer::Reset()
 {
     TimerState = ETimerState::None;
-    ElapsedTimeSeconds = 0;
+    ElapsedTime = FMillis(0);
 }
 
 void CTimer::Update()
@@ -41,13 +43,13 @@ void CTimer::Update()
         // If the timer has not reached the set time, update the elapsed time
         if (!EvaluateRuntime())
         {
-            ElapsedTimeSeconds = (millis() - StartTime) / 1000;
+            ElapsedTime = MillisNow().Since(StartTime);
 
-            if (bDebugTimer)
+            if (FConfig::bDebugLogging && bDebugTimer)
             {
                 Serial.print(TimerName);
-                Serial.print(" - Time Elapsed = ");
-                Serial.println(ElapsedTimeSeconds);
+                Serial.print(F(" - Time Elapsed(ms) = "));
+                Serial.println(ElapsedTime.Value);
             }
         }
         else
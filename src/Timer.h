@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "Fixed.h"
 
 enum class ETimerState
 {
@@ -14,10 +15,10 @@ class CTimer
 public:
 
 
-    CTimer(String _TimerName);
+    CTimer(const __FlashStringHelper *_TimerName);
 
     // Sets time to complete, does not start timer
-    void SetTimer(float Seconds);
+    void SetTimer(FSeconds Seconds);
 
     void StartTimer();
 
@@ -34,15 +35,18 @@ public:
 
     void SetDebugTimer(bool NewDebug);
 
+    FMillis GetElapsedTime() { return ElapsedTime; };
+
 private:
 
-    // Amount of seconds this timer will run
-    unsigned long RunTime{};
-    unsigned long StartTime{};
-    unsigned long ElapsedTimeSeconds{};
+    // Amount of time this timer will run
+    FMillis RunTime{};
+    FMillis StartTime{};
+    FMillis ElapsedTime{};
     bool bDebugTimer = false;
-    String TimerName{""};
+    // not copied, timer names are always F() string literals kept in flash
+    const __FlashStringHelper *TimerName = nullptr;
     ETimerState TimerState = ETimerState::None;
 
-    bool EvaluateRuntime() {return ElapsedTimeSeconds > RunTime; };
+    bool EvaluateRuntime() {return ElapsedTime > RunTime; };
 };
\ No newline at end of file
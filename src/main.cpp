@@ -1,222 +1,305 @@
 #include <Arduino.h>
-#include "Pins.h"
+#include "Config.h"
 #include "Checks.h"
 #include "Enums.h"
-#include "EEPROM.h"
 #include "Timer.h"
+#include "Policy.h"
+#include "Fixed.h"
+#include "Gate.h"
+#include "Hal.h"
+#include "Benchmark.h"
+#include "PulseDecoder.h"
+#include "SafetyBeam.h"
+#include "SerialCommand.h"
+
+// Gates are opened in index order and closed in reverse, StaggerDelay apart
+CGate *Gates[GATE_COUNT] = {};
+FSeconds StaggerDelay = ToSeconds(FMillis(FConfig::StaggerMillis));
+
+// A command held back because a leaf it moves has a hot motor, retried every loop until they've all cooled
+bool bThermalCommandQueued = false;
+EMoveDirection ThermalQueuedDirection = EMoveDirection::Idle;
 
-CChecks *StateCheck = nullptr;
-EMoveDirection LastMovementDirection{EMoveDirection::Idle};
-ECommandState CommandState = ECommandState::Ready;
-bool bTesting = true;
-bool bWantsNewTimeoutRecording = false;
 bool bOpenButtonPressAllowed = true;
 
-unsigned long EEPROMTimeoutMemLoc = 0;
-// value stored in EEProm which updates when a full open or close cycle completes
-// ensures the motor doesn't stay on in the case of a failure with one of the
-// limit switches... prevents motor overheat
-unsigned long ActiveTimeout = 10;
-
-bool bHasRecordedStartTime = false;
-// save any attempts here, if we complete a full cycle we update ActiveTimeout
-unsigned long TemporaryTimeoutRecording = 0;
-// will become true whenever button is pressed and then the gate opens or closes from an open or closed position
-// will then become false if a cycle completes (in which case we update) or fails (in which case we disregard)
-bool bIsRecordingNewTimeout = false;
-
 // if button pressed 2 times before timer max, set the active timeout recorder if only pressed once, open/close gate
 int setTimeoutButtonPressCounter = 0;
 int setTimeoutButtonPressTimer = -1;
-int setTimeoutButtonPressTimerMax = 100;
 
-// Blink the closed or open LED while closing or opening
-CTimer *BlinkLEDTimer = nullptr;
-CTimer *TimeoutTimer = nullptr;
+// Turns the pulses from the radio receiver into commands, a pin change interrupt times the pulses
+CPulseDecoder *RadioDecoder = nullptr;
 
-// Timer to disallow triggering a command after the radio module goes high, as it has an on time of around one second we
-// must block triggering function on more than one frame per button press
-CTimer *InputCooldownTimer = nullptr;
+// Stops and reverses closing gates, acts from its interrupt rather than the loop, only created when the profile has a beam
+CSafetyBeam *SafetyBeam = nullptr;
 
-//////////////// Master direction control ///////////////
-void SetOpening()
-{
-  TimeoutTimer->Reset();
-  TimeoutTimer->StartTimer();
-
-  // Allows gate to run, is set to ready when Idle is triggered by a button press during processing
-  // or when the gate reaches a limit or timeout is triggered
-  CommandState = ECommandState::Processing;
-
-  Serial.println("Opening State Set");
-  StateCheck->SetMovementState(EMoveDirection::Opening);
-  LastMovementDirection = EMoveDirection::Opening;
-  digitalWrite(openLEDPin, HIGH);
-  digitalWrite(closeLEDPin, LOW);
-  digitalWrite(idleLEDPin, LOW);
-  digitalWrite(relayControlClosePin, LOW);
-  digitalWrite(relayControlOpenPin, HIGH);
-}
+// Characters received over serial until a full line is available, reserved once in setup
+String SerialCommandBuffer = "";
+// Set once a line is longer than MaxSerialCommandLength, the rest of it is discarded
+bool bSerialCommandTooLong = false;
 
-void SetClosing()
-{
-  TimeoutTimer->Reset();
-  TimeoutTimer->StartTimer();
-
-  // Allows gate to run, is set to ready when Idle is triggered by a button press during processing
-  // or when the gate reaches a limit or timeout is triggered
-  CommandState = ECommandState::Processing;
-
-  Serial.println("Closing State Set");
-  StateCheck->SetMovementState(EMoveDirection::Closing);
-  LastMovementDirection = EMoveDirection::Closing;
-  digitalWrite(openLEDPin, LOW);
-  digitalWrite(closeLEDPin, HIGH);
-  digitalWrite(idleLEDPin, LOW);
-  digitalWrite(relayControlOpenPin, LOW);
-  digitalWrite(relayControlClosePin, HIGH);
-}
+#ifdef GATE_LOOP_PROFILE
+// Loop time is averaged over this many loops and printed, used to measure how the loop scales with GATE_COUNT
+const unsigned long LoopProfileCount = 1000;
+unsigned long LoopProfileTotalMicros = 0;
+unsigned long LoopProfileMaxMicros = 0;
+unsigned long LoopProfileLoops = 0;
+#endif
 
-void SetIdle()
+bool AnyGateMoving()
 {
-  TimeoutTimer->Reset();
-  Serial.println("Idle State Set");
-  StateCheck->SetMovementState(EMoveDirection::Idle);
-  CommandState = ECommandState::Ready;
-  digitalWrite(openLEDPin, LOW);
-  digitalWrite(closeLEDPin, LOW);
-  digitalWrite(idleLEDPin, HIGH);
-  digitalWrite(relayControlClosePin, LOW);
-  digitalWrite(relayControlOpenPin, LOW);
-}
+  if (bThermalCommandQueued)
+  {
+    return true;
+  }
 
-///////////////////////////////////////////////////////////
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
+  {
+    if (Gates[i]->IsMoving())
+    {
+      return true;
+    }
+  }
+  return false;
+}
 
-void CommandAction()
+// Stopping is never staggered
+void StopAllGates()
 {
-  switch (StateCheck->GetMoveDirection())
+  bThermalCommandQueued = false;
+
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
   {
-  case EMoveDirection::None:
-    SetIdle();
-    break;
+    if (Gates[i]->IsMoving())
+    {
+      Gates[i]->SetIdle();
+    }
+  }
+}
 
-  // if we're idle, check our position and move
-  case EMoveDirection::Idle:
+// Moves every stopped leaf that isn't already at the target limit, staggered
+// the first leaf opens first and closes last so overlapping leaves don't clash
+void MoveAllGates(EMoveDirection Direction)
+{
+  bool bOpening = Direction == EMoveDirection::Opening;
+  EPosition Target = bOpening ? EPosition::Open : EPosition::Closed;
 
-    switch (StateCheck->GetGatePosition())
+  // The whole command waits for a hot motor, starting the leaves that can run would break the opening order
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
+  {
+    if (!Gates[i]->IsMoving() && Gates[i]->GetGatePosition() != Target && !Gates[i]->CanStartRun())
     {
-      // if we're open, close and process command
-    case EPosition::Open:
-
-      SetClosing();
-      if (bWantsNewTimeoutRecording)
+      if (!bThermalCommandQueued)
       {
-        bIsRecordingNewTimeout = true;
+        Serial.println(F("Motor hot, command queued until it cools"));
+        Gates[i]->PrintThermal();
       }
-      StateCheck->LastGatePosition = EPosition::Open;
-      break;
+      bThermalCommandQueued = true;
+      ThermalQueuedDirection = Direction;
+      return;
+    }
+  }
 
-    // if we're closed, open and process command
-    case EPosition::Closed:
+  if (bThermalCommandQueued)
+  {
+    bThermalCommandQueued = false;
+    Serial.println(F("Motor cooled, running queued command"));
+  }
 
-      SetOpening();
-      if (bWantsNewTimeoutRecording)
-      {
-        bIsRecordingNewTimeout = true;
-      }
-      StateCheck->LastGatePosition = EPosition::Closed;
-      break;
+  uint8_t Order = 0;
+  for (uint8_t n = 0; n < GATE_COUNT; n++)
+  {
+    uint8_t i = bOpening ? n : GATE_COUNT - 1 - n;
+    if (!Gates[i]->IsMoving() && Gates[i]->GetGatePosition() != Target)
+    {
+      Gates[i]->QueueMove(Direction, StaggerDelay.Scale(Order, 1));
+      Order++;
+    }
+  }
+}
 
-    case EPosition::Unknown:
+// A radio or button press - stops every gate if any are moving, otherwise opens them all if they're all closed
+// and closes them all if not, so a part open leaf after a pedestrian opening or a timeout closes with the rest
+void CommandAllGates()
+{
+  if (AnyGateMoving())
+  {
+    StopAllGates();
+    return;
+  }
 
-      // In all cases, if the gate is stopped and the position is unknown, open
-      // the gate, this is for maximum safety
-      // Note - set closing, somehow the positions got reversed - TODO FIX THIS
-      //SetOpening();
-      SetClosing();
+  bool bAllClosed = true;
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
+  {
+    if (Gates[i]->GetGatePosition() != EPosition::Closed)
+    {
+      bAllClosed = false;
+    }
+  }
 
-      break;
+  MoveAllGates(bAllClosed ? EMoveDirection::Opening : EMoveDirection::Closing);
+}
 
-    default:
-      break;
+bool AnyGateSafetyReversing()
+{
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
+  {
+    if (Gates[i]->IsSafetyReversing())
+    {
+      return true;
     }
-    break;
+  }
+  return false;
+}
 
-  // When opening and a command is triggered, set idle
-  case EMoveDirection::Opening:
-    SetIdle();
-    break;
+// Safety beam - every closing leaf reverses and no close waiting for its stagger or a hot motor goes ahead
+void ReverseAllGates()
+{
+  if (bThermalCommandQueued && ThermalQueuedDirection == EMoveDirection::Closing)
+  {
+    bThermalCommandQueued = false;
+  }
 
-  // When closing and a command is triggered, set idle
-  case EMoveDirection::Closing:
-    SetIdle();
-    break;
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
+  {
+    Gates[i]->SafetyReverse();
   }
 }
 
-void RecordNewActiveTimeout()
+// Auto close - closes every gate that isn't already closed, in reverse order
+void CloseAllGates()
+{
+  MoveAllGates(EMoveDirection::Closing);
+}
+
+void FlashAllGateLEDs(uint8_t Flashes, unsigned long DelayMillis)
 {
-  unsigned long CompletedRecordingTimeMillis = millis();
+  for (uint8_t Flash = 0; Flash < Flashes; Flash++)
+  {
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+      Gates[i]->WriteLEDs(HIGH, HIGH, LOW);
+    }
+    delay(DelayMillis);
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+      Gates[i]->WriteLEDs(LOW, LOW, LOW);
+    }
+    delay(DelayMillis);
+  }
+}
 
-  unsigned long NewSoftwareLimitTime = CompletedRecordingTimeMillis - TemporaryTimeoutRecording;
+void HandleSerialCommand(const String &Command)
+{
+  // Pedestrian openings only ever use the first leaf
+  if (Command == "ped")
+  {
+    Gates[0]->PedestrianAction();
+    return;
+  }
 
-  // Only save larger value to prevent short stops in operation
-  if ((NewSoftwareLimitTime+ (NewSoftwareLimitTime / 10) > ActiveTimeout)
+  // Motor temperature estimates
+  if (Command == "thermal")
   {
-    // Add ten percent to make sure we don't cut off too early
-    ActiveTimeout = abs(NewSoftwareLimitTime + (NewSoftwareLimitTime / 10)) / 1000;
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+      Gates[i]->PrintThermal();
+    }
+    return;
+  }
 
-    TemporaryTimeoutRecording = 0;
-    EEPROM.put(EEPROMTimeoutMemLoc, static_cast<float>(ActiveTimeout));
+  long Value = 0;
+  if (MatchSerialCommand(Command, "stagger", Value))
+  {
+    const long MaxStaggerSeconds = FConfig::MaxStaggerMillis / 1000;
+    StaggerDelay = FSeconds::FromInt(Value > MaxStaggerSeconds ? MaxStaggerSeconds : Value);
+    Serial.print(F("Stagger delay = "));
+    Serial.print(StaggerDelay.GetWhole());
+    Serial.println(F("s"));
+    return;
+  }
 
-    Serial.print("Saving new timeout = ");
-    Serial.println(static_cast<float>(ActiveTimeout));
+#ifdef GATE_SIMULATION
+  if (Simulation->HandleSerialCommand(Command))
+  {
+    return;
   }
-  else
+#endif
+
+  // Policy settings apply to every gate
+  bool bHandled = false;
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
   {
-    Serial.print("New Timeout Shorter than Existing, discarding new timeout value...");
+    if (Gates[i]->GetPolicy()->HandleSerialCommand(Command))
+    {
+      bHandled = true;
+    }
   }
 
-  bHasRecordedStartTime = false;
-  bWantsNewTimeoutRecording = false;
+  if (!bHandled)
+  {
+    Serial.print(F("Unknown command: "));
+    Serial.println(Command);
+  }
+}
+
+// Reads serial without blocking, a command is handled once a full line has been received
+void ProcessSerialCommands()
+{
+  while (Serial.available() > 0)
+  {
+    char Received = Serial.read();
+
+    if (Received == '\n' || Received == '\r')
+    {
+      if (bSerialCommandTooLong)
+      {
+        Serial.println(F("Serial command too long, ignored"));
+      }
+      else if (SerialCommandBuffer.length() > 0)
+      {
+        HandleSerialCommand(SerialCommandBuffer);
+      }
+      SerialCommandBuffer = "";
+      bSerialCommandTooLong = false;
+    }
+    else if (SerialCommandBuffer.length() < MaxSerialCommandLength)
+    {
+      SerialCommandBuffer += Received;
+    }
+    else
+    {
+      bSerialCommandTooLong = true;
+    }
+  }
 }
 
 bool InitializeProgram()
 {
-  if (!StateCheck)
-  {
-    Serial.println("Initializing Program");
-    StateCheck = new CChecks();
-
-    BlinkLEDTimer = new CTimer("BlinkTimer");
-    BlinkLEDTimer->SetTimer(.5);
-    BlinkLEDTimer->StartTimer();
-
-    TimeoutTimer = new CTimer("TimeoutTimer");
-    float getEEPROM = EEPROM.get(EEPROMTimeoutMemLoc, getEEPROM);
-    TimeoutTimer->SetTimer(getEEPROM);
-    ActiveTimeout = getEEPROM;
-    Serial.print("Timeout = ");
-    Serial.print(getEEPROM);
-    Serial.println(" seconds");
-
-    TimeoutTimer->SetDebugTimer(false);
-    InputCooldownTimer = new CTimer("CooldownTimer");
-    InputCooldownTimer->SetTimer(1.5);
-
-    digitalWrite(openLEDPin, HIGH);
-    digitalWrite(closeLEDPin, HIGH);
-    delay(100);
-    digitalWrite(openLEDPin, LOW);
-    digitalWrite(closeLEDPin, LOW);
-    delay(100);
-    digitalWrite(openLEDPin, HIGH);
-    digitalWrite(closeLEDPin, HIGH);
-    delay(100);
-    digitalWrite(openLEDPin, LOW);
-    digitalWrite(closeLEDPin, LOW);
-    Serial.print("Initialization Complete - Timeout is ");
-    Serial.println(ActiveTimeout);
+  if (!Gates[0])
+  {
+    Serial.println(F("Initializing Program"));
+
+    Gates[0] = new TGate<FConfig::LeafA>(0);
+#if GATE_COUNT > 1
+    Gates[1] = new TGate<FConfig::LeafB>(1);
+#endif
+
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
+    {
+      Gates[i]->Initialize();
+    }
+
+    RadioDecoder = new CPulseDecoder(FConfig::Inputs::Radio);
+    RadioDecoder->Begin();
+
+    if (FConfig::bSafetyBeam)
+    {
+      SafetyBeam = new CSafetyBeam(FConfig::Inputs::SafetyBeam, Gates, GATE_COUNT);
+      SafetyBeam->Begin();
+    }
+
+    FlashAllGateLEDs(2, 100);
+    Serial.println(F("Initialization Complete"));
     return false;
   }
   else
@@ -227,67 +310,80 @@ bool InitializeProgram()
 
 void setup()
 {
-  pinMode(closeLEDPin, OUTPUT);
-  pinMode(relayControlClosePin, OUTPUT);
-  pinMode(relayControlOpenPin, OUTPUT);
-  pinMode(openLEDPin, OUTPUT);
-  pinMode(idleLEDPin, OUTPUT);
-  pinMode(setSoftwareLimitSwitch, INPUT);
-  pinMode(reedSwitchClosedPin, INPUT);
-  pinMode(reedSwitchOpenPin, INPUT);
-  Serial.begin(9600);
+  pinMode(FConfig::Inputs::SetLimitButton, INPUT);
+  Serial.begin(FConfig::SerialBaud);
+  SerialCommandBuffer.reserve(MaxSerialCommandLength);
+
+#ifdef GATE_SIMULATION
+  // must exist before the gates read their reed switches
+  Simulation = new CSimulation();
+  Serial.println(F("Running against the simulated gate"));
+#endif
 
   if (!InitializeProgram())
   {
+#ifdef GATE_BENCHMARK
+    // never returns
+    RunBenchmarks();
+#endif
     return;
   }
 }
 
-void UpdateTimers()
-{
-  TimeoutTimer->Update();
-  InputCooldownTimer->Update();
-  BlinkLEDTimer->Update();
-}
-
 void loop()
 {
-  UpdateTimers();
+#ifdef GATE_LOOP_PROFILE
+  unsigned long LoopStartMicros = micros();
+#endif
+
+#ifdef GATE_SIMULATION
+  Simulation->Step();
+#endif
 
-  // Set the gate position every frame, used to process movement directions and what to do if we're not at a limit switch
-  StateCheck->CheckAndSetCurrentPosition();
+  ProcessSerialCommands();
 
-  // Blink LED if Idle and at a limit
-  if (StateCheck->GetMoveDirection() == EMoveDirection::Idle)
+  // The radio input is decoded once and shared by every gate, double presses only mean something with pedestrian mode on
+  RadioDecoder->SetDoublePressEnabled(Gates[0]->GetPolicy()->IsPedestrianEnabled());
+  ERadioCommand RadioCommand = RadioDecoder->Update();
+  // Hold open only counts a press held past a long press, a shorter one ends as a Toggle that closes the gate anyway
+  bool bRadioHeld = RadioDecoder->IsLongHeld();
+
+  // The interrupt handles the beam breaking, this catches gates told to close while it's still broken
+  bool bBeamBroken = false;
+  if (FConfig::bSafetyBeam)
   {
-    // blink the open or close position LED's while awaiting command
-    if (BlinkLEDTimer->GetTimerState() == ETimerState::Complete)
-    {
-      BlinkLEDTimer->Reset();
+    SafetyBeam->Update();
+    bBeamBroken = SafetyBeam->IsBroken();
+  }
 
-      if (StateCheck->GetGatePosition() == EPosition::Closed)
-      {
-        digitalWrite(openLEDPin, LOW);
-        digitalWrite(idleLEDPin, LOW);
-        digitalWrite(closeLEDPin, !digitalRead(closeLEDPin));
-      }
-      else if (StateCheck->GetGatePosition() == EPosition::Open)
-      {
-        digitalWrite(closeLEDPin, LOW);
-        digitalWrite(idleLEDPin, LOW);
-        digitalWrite(openLEDPin, !digitalRead(openLEDPin));
-      }
-      else if (StateCheck->GetGatePosition() == EPosition::Unknown)
-      {
-        digitalWrite(closeLEDPin, LOW);
-        digitalWrite(openLEDPin, LOW);
-        digitalWrite(idleLEDPin, !digitalRead(idleLEDPin));
-      }
+  bool bWantsAutoClose = false;
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
+  {
+    if (Gates[i]->Update(bRadioHeld, bBeamBroken) == EPolicyAction::Close)
+    {
+      bWantsAutoClose = true;
     }
   }
 
+  // A leaf reversing for the beam reverses the whole gate, otherwise a leaf still waiting out its stagger
+  // would start closing into the obstruction after the other one had reopened
+  if (FConfig::bSafetyBeam && AnyGateSafetyReversing())
+  {
+    ReverseAllGates();
+    bWantsAutoClose = false;
+  }
+
+  if (bWantsAutoClose)
+  {
+    CloseAllGates();
+  }
+  else if (bThermalCommandQueued)
+  {
+    MoveAllGates(ThermalQueuedDirection);
+  }
+
   /////////////////// Button presses for opening gate or setting limit setup mode
-  bool setLimitButtonState = digitalRead(setSoftwareLimitSwitch);
+  bool setLimitButtonState = HalDigitalRead(FConfig::Inputs::SetLimitButton);
 
   // only allow one button press to be added per button release
   if (!bOpenButtonPressAllowed)
@@ -302,7 +398,7 @@ void loop()
     if (setLimitButtonState && setTimeoutButtonPressTimer == -1)
     {
       setTimeoutButtonPressTimer = 0;
-      Serial.println("setSoftwareLimitSwitch Pressed! Timer Started");
+      Serial.println(F("setSoftwareLimitSwitch Pressed! Timer Started"));
     }
   }
 
@@ -312,11 +408,14 @@ void loop()
   // Manual button presses
   if (setTimeoutButtonPressTimer != -1)
   {
-    if (setTimeoutButtonPressTimer < setTimeoutButtonPressTimerMax)
+    if (setTimeoutButtonPressTimer < FConfig::SetLimitButtonWindowLoops)
     {
       setTimeoutButtonPressTimer++;
 
-      Serial.println(setTimeoutButtonPressTimer);
+      if (FConfig::bDebugLogging)
+      {
+        Serial.println(setTimeoutButtonPressTimer);
+      }
       if (setLimitButtonState)
       {
         if (bOpenButtonPressAllowed)
@@ -332,175 +431,90 @@ void loop()
       {
         setLimits = true;
         setTimeoutButtonPressCounter = 0;
-        Serial.println("Selected Set Limit Mode");
+        Serial.println(F("Selected Set Limit Mode"));
       }
       else if (setTimeoutButtonPressCounter == 1)
       {
         commandSignal = true;
         setTimeoutButtonPressCounter = 0;
-        Serial.println("Manual Command Selected");
+        Serial.println(F("Manual Command Selected"));
       }
       setTimeoutButtonPressTimer = -1;
     }
   }
-  if (setLimits && !bWantsNewTimeoutRecording)
-  {
-    Serial.println("setSoftwareLimitSwitch Pressed!");
-    bWantsNewTimeoutRecording = true;
-    digitalWrite(idleLEDPin, LOW);
-    digitalWrite(openLEDPin, HIGH);
-    digitalWrite(closeLEDPin, HIGH);
-    delay(500);
-    digitalWrite(openLEDPin, LOW);
-    digitalWrite(closeLEDPin, LOW);
-    delay(500);
-    digitalWrite(openLEDPin, HIGH);
-    digitalWrite(closeLEDPin, HIGH);
-    delay(500);
-    digitalWrite(openLEDPin, LOW);
-    digitalWrite(closeLEDPin, LOW);
-  }
-
-  //Manual button press occurred, skip the pin check and run the command actions
-  if (commandSignal)
-  {
-    Serial.println("Manual Override Button Pressed");
-    commandSignal = false;
-    goto ManualCommand;
-  }
 
-  // Check if we have a high signal on the radio input
-  if (StateCheck->ProcessControlSignal())
+  if (setLimits)
   {
-
-  ManualCommand:
-    // block reading any additional high inputs until the timer runs out, this allows time for the remote relay to switch off
-    switch (InputCooldownTimer->GetTimerState())
+    Serial.println(F("setSoftwareLimitSwitch Pressed!"));
+    for (uint8_t i = 0; i < GATE_COUNT; i++)
     {
-    // A new timer or a reset timer has a None ETimerState, therefor we can start the timer and start an action
-    case ETimerState::None:
-
-      // Set Input timer state to Running
-      InputCooldownTimer->StartTimer();
-      CommandAction();
-      break;
-
-    case ETimerState::Running:
-      // Do nothing, we cannot trigger this more than once per button press
-      break;
-    case ETimerState::Complete:
-      // Setting back to None state will now allow a new command action to be triggered by a button press
-      InputCooldownTimer->Reset();
-      break;
-
-    default:
-      break;
+      Gates[i]->RequestTimeoutRecording();
     }
+    FlashAllGateLEDs(2, 500);
   }
 
-  //////////////// The gate is actioning the last command here ////////////////////////
-
-  // Motor protection timeout is handled here - shuts off motor if the timer reaches completion
-  // Set Idle returns the timer state to None, allowing a new start timer to occur with each command received
-  if (TimeoutTimer->GetTimerState() == ETimerState::Complete)
+  //Manual button press occurred, this is the same as a short radio press
+  if (commandSignal)
   {
-    // Run the timeout while processing
-    if (!bIsRecordingNewTimeout || !bWantsNewTimeoutRecording)
-    {
-      {
-        if (StateCheck->GetMoveDirection() == EMoveDirection::Opening)
-        {
-          Serial.println("Opening Timed Out");
-        }
-        else if (StateCheck->GetMoveDirection() == EMoveDirection::Closing)
-        {
-          Serial.println("Closing Timed Out");
-        }
-
-        SetIdle();
-        return;
-      }
-    }
+    Serial.println(F("Manual Override Button Pressed"));
+    commandSignal = false;
+    RadioCommand = ERadioCommand::Toggle;
   }
 
-  // if the gate is currently operating
-  if (CommandState == ECommandState::Processing)
+  switch (RadioCommand)
   {
-    // check to see if we've reached the open position
-    switch (StateCheck->GetMoveDirection())
-    {
-    case EMoveDirection::Opening:
-
-      // Runs if we're setting a new timeout
-      if (bIsRecordingNewTimeout)
-      {
-        if (!bHasRecordedStartTime)
-        {
-          bHasRecordedStartTime = true;
-          TemporaryTimeoutRecording = millis(); //get the current "time" (actually the number of milliseconds since the program started)
-          Serial.print("Start Time = ");
-          Serial.println(TemporaryTimeoutRecording);
-        }
-
-        Serial.print("Setting new timeout - elapsed time(seconds) = ");
-        Serial.println((millis() - TemporaryTimeoutRecording) / 1000);
-      }
-
-      if (StateCheck->GetGatePosition() == EPosition::Open)
-      {
-        // Reached open position while opening
-        Serial.println("Open position reached! Set IDLE");
-
-        // we have completed a full opening cycle, record the new value if significantly different
-        // from previous recordings
-        if (bIsRecordingNewTimeout)
-        {
-          bIsRecordingNewTimeout = false;
-          RecordNewActiveTimeout();
-        }
-
-        SetIdle();
-        return;
-      }
-      break;
+  case ERadioCommand::Toggle:
+    CommandAllGates();
+    break;
 
-    case EMoveDirection::Closing:
-      if (bIsRecordingNewTimeout)
-      {
-        if (!bHasRecordedStartTime)
-        {
-          bHasRecordedStartTime = true;
-          TemporaryTimeoutRecording = millis(); //get the current "time" (actually the number of milliseconds since the program started)
-          Serial.print("Start Time = ");
-          Serial.println(TemporaryTimeoutRecording);
-        }
-      }
+  // A long press stops every gate
+  case ERadioCommand::Stop:
+    Serial.println(F("Stop Command Received"));
+    StopAllGates();
+    break;
 
-      if (StateCheck->GetGatePosition() == EPosition::Closed)
-      {
-        // Reached closed position while closing
-        Serial.println("Closed position reached! Set IDLE");
+  case ERadioCommand::Pedestrian:
+    Serial.println(F("Pedestrian Command Received"));
+    Gates[0]->PedestrianAction();
+    break;
 
-        // we have completed a full closing cycle, record the new value
-        if (bIsRecordingNewTimeout)
-        {
-          bIsRecordingNewTimeout = false;
-          RecordNewActiveTimeout();
-        }
+  default:
+    break;
+  }
 
-        SetIdle();
-        return;
-      }
-      break;
+#ifdef GATE_SIMULATION
+  // Lets the simulated clock skip over time in which nothing is waiting to happen
+  unsigned long IdleMillis = RadioDecoder->IsIdle() && setTimeoutButtonPressTimer == -1 ? 0xFFFFFFFFUL : 0;
+  for (uint8_t i = 0; i < GATE_COUNT; i++)
+  {
+    unsigned long GateIdleMillis = Gates[i]->GetIdleMillis();
+    if (GateIdleMillis < IdleMillis)
+    {
+      IdleMillis = GateIdleMillis;
+    }
+  }
+  Simulation->AllowSkip(IdleMillis);
+#endif
 
-    case EMoveDirection::Idle:
-      // If we're already idle, stay idle.
-      Serial.println("Already Idle, gate must have been stopped manually or timed out.");
-      break;
+#ifdef GATE_LOOP_PROFILE
+  unsigned long LoopMicros = micros() - LoopStartMicros;
+  LoopProfileTotalMicros += LoopMicros;
+  if (LoopMicros > LoopProfileMaxMicros)
+  {
+    LoopProfileMaxMicros = LoopMicros;
+  }
 
-    default:
-      Serial.println("Error: Default case. Set IDLE");
-      SetIdle();
-    }
+  if (++LoopProfileLoops >= LoopProfileCount)
+  {
+    Serial.print(F("Loop profile - gates = "));
+    Serial.print(GATE_COUNT);
+    Serial.print(F(", average(us) = "));
+    Serial.print(LoopProfileTotalMicros / LoopProfileLoops);
+    Serial.print(F(", max(us) = "));
+    Serial.println(LoopProfileMaxMicros);
+    LoopProfileTotalMicros = 0;
+    LoopProfileMaxMicros = 0;
+    LoopProfileLoops = 0;
   }
-}
\ No newline at end of file
+#endif
+}
@@ -0,0 +1,113 @@
+#include <unity.h>
+#include "Config.h"
+#include "Fixed.h"
+
+// Fixed point arithmetic and the EEPROM timeout formats, run on the host with pio test -e native_test
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+//////////////// TFixed ///////////////
+
+void TestScale()
+{
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::FromInt(11).GetRaw(), FSeconds::FromInt(10).Scale(11, 10).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::One + FSeconds::One / 2, FSeconds::FromRatio(3, 2).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(0, FSeconds::FromInt(100).Scale(0, 7).GetRaw());
+}
+
+void TestScaleSaturates()
+{
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::MaxRaw, FSeconds::FromInt(40000).Scale(2, 1).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::MaxRaw, FSeconds::FromRaw(FSeconds::MaxRaw).Scale(11, 10).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::MaxRaw, FSeconds::FromInt(1).Scale(1, 0).GetRaw());
+}
+
+void TestAddSubtractSaturate()
+{
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::MaxRaw, (FSeconds::FromRaw(FSeconds::MaxRaw - 1) + FSeconds::FromRaw(5)).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::MaxRaw, (FSeconds::FromRaw(FSeconds::MaxRaw) + FSeconds::FromRaw(FSeconds::MaxRaw)).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(0, (FSeconds::FromInt(1) - FSeconds::FromInt(2)).GetRaw());
+}
+
+//////////////// Millisecond conversions ///////////////
+
+void TestToSeconds()
+{
+    TEST_ASSERT_EQUAL_UINT32(0, ToSeconds(FMillis(0)).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::One, ToSeconds(FMillis(1000)).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::FromRatio(3, 2).GetRaw(), ToSeconds(FMillis(1500)).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::FromInt(65535).GetRaw(), ToSeconds(FMillis(65535000UL)).GetRaw());
+}
+
+void TestToSecondsSaturates()
+{
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::MaxRaw, ToSeconds(FMillis(65536000UL)).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::MaxRaw, ToSeconds(FMillis(0xFFFFFFFFUL)).GetRaw());
+}
+
+void TestToMillis()
+{
+    TEST_ASSERT_EQUAL_UINT32(25000, ToMillis(FSeconds::FromInt(25)).Value);
+    TEST_ASSERT_EQUAL_UINT32(125, ToMillis(FSeconds::FromRatio(1, 8)).Value);
+
+    // the round trip truncates, it never gains time
+    uint32_t RoundTrip = ToMillis(ToSeconds(FMillis(12345))).Value;
+    TEST_ASSERT_TRUE(RoundTrip <= 12345 && RoundTrip >= 12344);
+}
+
+void TestMillisSinceWraps()
+{
+    TEST_ASSERT_EQUAL_UINT32(10, FMillis(5).Since(FMillis(0xFFFFFFFBUL)).Value);
+}
+
+//////////////// EEPROM timeout formats ///////////////
+
+void TestLegacyFloatTimeouts()
+{
+    // 25.0f, 12.5f and 300.0f as written by older firmware
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::FromInt(25).GetRaw(), DecodeLegacyFloatTimeout(0x41C80000UL).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::FromRatio(25, 2).GetRaw(), DecodeLegacyFloatTimeout(0x41480000UL).GetRaw());
+    TEST_ASSERT_EQUAL_UINT32(FSeconds::FromInt(300).GetRaw(), DecodeLegacyFloatTimeout(0x43960000UL).GetRaw());
+}
+
+void TestLegacyFloatTimeoutsRejected()
+{
+    // 0.5f is under a second, -5.0f is negative
+    TEST_ASSERT_TRUE(DecodeLegacyFloatTimeout(0x3F000000UL).IsZero());
+    TEST_ASSERT_TRUE(DecodeLegacyFloatTimeout(0xC0A00000UL).IsZero());
+
+    // a Q16.16 timeout isn't read as a float
+    TEST_ASSERT_TRUE(DecodeLegacyFloatTimeout(FSeconds::FromInt(10).GetRaw()).IsZero());
+}
+
+void TestErasedEEPROM()
+{
+    // neither format accepts an erased cell, so the gate falls back to its default timeout
+    const uint32_t Erased = 0xFFFFFFFFUL;
+    TEST_ASSERT_TRUE(DecodeLegacyFloatTimeout(Erased).IsZero());
+    TEST_ASSERT_TRUE(FSeconds::FromRaw(Erased) > ToSeconds(FMillis(FConfig::MaxTimeoutMillis)));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(TestScale);
+    RUN_TEST(TestScaleSaturates);
+    RUN_TEST(TestAddSubtractSaturate);
+    RUN_TEST(TestToSeconds);
+    RUN_TEST(TestToSecondsSaturates);
+    RUN_TEST(TestToMillis);
+    RUN_TEST(TestMillisSinceWraps);
+    RUN_TEST(TestLegacyFloatTimeouts);
+    RUN_TEST(TestLegacyFloatTimeoutsRejected);
+    RUN_TEST(TestErasedEEPROM);
+
+    return UNITY_END();
+}